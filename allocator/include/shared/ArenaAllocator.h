@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+
+#include "shared/BasicArena.h"
+
+namespace Arena {
+
+// ArenaType is any arena exposing allocate(size, align) and
+// deallocate(std::byte*, size), eg. BasicArena<N> or GrowableArena<N>
+template <typename ArenaType>
+// Arena Resource adapts an arena to std::pmr::memory_resource, so std::pmr
+// containers (std::pmr::vector, std::pmr::string, ...) can allocate from it.
+//
+// The resource does not own the arena, the arena must outlive it and every
+// container using it.
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+  explicit ArenaResource(ArenaType& arena) noexcept : _arena(arena) {}
+
+  ArenaType& arena() const noexcept { return _arena; }
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    return _arena.allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    auto* ptr = static_cast<std::byte*>(p);
+    // Arenas with a fallback policy need the alignment to give it back
+    if constexpr (requires { _arena.deallocate(ptr, bytes, alignment); }) {
+      _arena.deallocate(ptr, bytes, alignment);
+    } else {
+      _arena.deallocate(ptr, bytes);
+    }
+  }
+
+  // Two resources are only interchangeable if they share the same arena
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    auto* o = dynamic_cast<const ArenaResource*>(&other);
+    return o != nullptr && &o->_arena == &_arena;
+  }
+
+  ArenaType& _arena;
+};
+
+// T is the element type, ArenaType the arena to allocate from
+template <typename T, typename ArenaType>
+// Arena Allocator is a std::allocator-conforming allocator for plain STL
+// containers (std::vector<T, ArenaAllocator<T, A>>, ...) that forwards to an
+// arena it does not own. Copies, and rebinds to other element types, share
+// the same arena.
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  explicit ArenaAllocator(ArenaType& arena) noexcept : _arena(&arena) {}
+
+  // Rebind constructor, used by containers to allocate their nodes
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U, ArenaType>& other) noexcept
+      : _arena(&other.arena()) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    auto* ptr = reinterpret_cast<std::byte*>(p);
+    // Arenas with a fallback policy need the alignment to give it back
+    if constexpr (requires { _arena->deallocate(ptr, n, alignof(T)); }) {
+      _arena->deallocate(ptr, n * sizeof(T), alignof(T));
+    } else {
+      _arena->deallocate(ptr, n * sizeof(T));
+    }
+  }
+
+  ArenaType& arena() const noexcept { return *_arena; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U, ArenaType>& other) const noexcept {
+    return _arena == &other.arena();
+  }
+
+ private:
+  ArenaType* _arena;
+};
+
+}  // namespace Arena
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace Arena {
+
+constexpr size_t max_alignment = alignof(std::max_align_t);
+
+// Fallback policies decide what an arena does once it cannot serve a request
+// from its own memory. They are plugged in as a template parameter and only
+// ever reached from the arena's cold path:
+//   static void* allocate(size_t s, size_t align)
+//   static void deallocate(std::byte* ptr, size_t s, size_t align) noexcept
+// deallocate() is handed every pointer that does not belong to the arena.
+
+// Falls back to the global heap (the original BasicArena behaviour)
+struct HeapFallback {
+  static void* allocate(size_t s, size_t align) {
+    if (align > max_alignment) {
+      return ::operator new(s, std::align_val_t(align));
+    }
+    return ::operator new(s);
+  }
+
+  static void deallocate(std::byte* ptr, size_t, size_t align) noexcept {
+    if (align > max_alignment) {
+      ::operator delete(static_cast<void*>(ptr), std::align_val_t(align));
+      return;
+    }
+    ::operator delete(static_cast<void*>(ptr));
+  }
+};
+
+// Throws std::bad_alloc, for arenas that must never leak onto the heap
+struct ThrowFallback {
+  [[noreturn]] static void* allocate(size_t, size_t) {
+    throw std::bad_alloc();
+  }
+
+  static void deallocate(std::byte*, size_t, size_t) noexcept {}
+};
+
+// Returns nullptr and leaves it to the caller
+struct NullFallback {
+  static void* allocate(size_t, size_t) noexcept { return nullptr; }
+
+  static void deallocate(std::byte*, size_t, size_t) noexcept {}
+};
+
+// Forwards to a pair of free functions, eg. to count overflows or to hand
+// them to a bigger upstream arena
+template <void* (*Allocate)(size_t, size_t),
+          void (*Deallocate)(std::byte*, size_t, size_t)>
+struct CallbackFallback {
+  static void* allocate(size_t s, size_t align) { return Allocate(s, align); }
+
+  static void deallocate(std::byte* ptr, size_t s, size_t align) noexcept {
+    Deallocate(ptr, s, align);
+  }
+};
+
+}  // namespace Arena
@@ -0,0 +1,33 @@
+#pragma once
+
+namespace Arena {
+
+// ArenaType is any arena exposing mark() and rollback(Marker), eg.
+// BasicArena<N> or GrowableArena<N>
+template <typename ArenaType>
+// Arena Scope takes a marker on construction and rolls the arena back to it
+// on destruction, releasing every allocation made inside the scope with a
+// single pointer reset. Scopes nest naturally, an inner scope always ends
+// before the outer one.
+//
+// Destructors of objects placed in the scope are NOT run, it is meant for
+// trivially destructible temporaries (or ones destroyed by hand).
+class ArenaScope {
+ public:
+  explicit ArenaScope(ArenaType& arena) noexcept
+      : _arena(arena), _marker(arena.mark()) {}
+
+  ~ArenaScope() { _arena.rollback(_marker); }
+
+  // A scope is tied to a lexical block, it cannot be copied or moved
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+  ArenaScope(ArenaScope&&) = delete;
+  ArenaScope& operator=(ArenaScope&&) = delete;
+
+ private:
+  ArenaType& _arena;
+  typename ArenaType::Marker _marker;
+};
+
+}  // namespace Arena
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <string>
+
+namespace Arena {
+
+// Stats policies are plugged into arenas and pools as a template parameter.
+// The owner calls the hooks below, it is up to the policy what to record:
+//   onAllocate(requested, padding) - served from the owner's own memory
+//   onFallback(requested)          - had to fall back (eg. to the heap)
+//   onDeallocate(reclaimed)        - one block freed, reclaimed bytes re-usable
+//   onRelease(reclaimed)           - bulk release (eg. rollback to a marker)
+
+// Records nothing, every hook compiles away. This is the default everywhere.
+struct NoArenaStats {
+  static constexpr bool enabled = false;
+
+  void onAllocate(size_t, size_t) noexcept {}
+  void onFallback(size_t) noexcept {}
+  void onDeallocate(size_t) noexcept {}
+  void onRelease(size_t) noexcept {}
+};
+
+// Counts requested vs padding bytes, heap fall-backs, the high-water mark of
+// bytes held and a power-of-two histogram of requested sizes. Meant to size
+// arenas and pools correctly, not for the hot path of production builds.
+class ArenaStats {
+ public:
+  static constexpr bool enabled = true;
+
+  // Bucket i counts requests of (2^(i-1), 2^i] bytes, the last bucket counts
+  // everything bigger
+  static constexpr size_t histogram_buckets = 20;
+
+  void onAllocate(size_t requested, size_t padding) noexcept {
+    _allocations++;
+    _bytesRequested += requested;
+    _bytesPadding += padding;
+    _inUse += requested + padding;
+    _highWaterMark = std::max(_highWaterMark, _inUse);
+    _histogram[bucket_of(requested)]++;
+  }
+
+  void onFallback(size_t requested) noexcept {
+    _fallbacks++;
+    _fallbackBytes += requested;
+    _histogram[bucket_of(requested)]++;
+  }
+
+  void onDeallocate(size_t reclaimed) noexcept {
+    _deallocations++;
+    _inUse -= reclaimed;
+  }
+
+  void onRelease(size_t reclaimed) noexcept { _inUse -= reclaimed; }
+
+  size_t allocations() const noexcept { return _allocations; }
+  size_t deallocations() const noexcept { return _deallocations; }
+  size_t bytes_requested() const noexcept { return _bytesRequested; }
+  size_t bytes_padding() const noexcept { return _bytesPadding; }
+  size_t fallbacks() const noexcept { return _fallbacks; }
+  size_t fallback_bytes() const noexcept { return _fallbackBytes; }
+  size_t in_use() const noexcept { return _inUse; }
+  size_t high_water_mark() const noexcept { return _highWaterMark; }
+
+  const std::array<size_t, histogram_buckets>& size_histogram()
+      const noexcept {
+    return _histogram;
+  }
+
+  static constexpr size_t bucket_of(size_t requested) noexcept {
+    return std::min<size_t>(std::bit_width(requested - (requested != 0)),
+                            histogram_buckets - 1);
+  }
+
+  // Largest request counted by bucket i (the last bucket has no bound)
+  static constexpr size_t bucket_upper_bound(size_t i) noexcept {
+    return size_t(1) << i;
+  }
+
+  void reset() noexcept { *this = ArenaStats(); }
+
+  // Single line JSON object with every counter and the non-empty buckets
+  std::string toJson() const;
+
+ private:
+  size_t _allocations = 0;
+  size_t _deallocations = 0;
+  size_t _bytesRequested = 0;
+  size_t _bytesPadding = 0;
+  size_t _fallbacks = 0;
+  size_t _fallbackBytes = 0;
+  size_t _inUse = 0;
+  size_t _highWaterMark = 0;
+  std::array<size_t, histogram_buckets> _histogram{};
+};
+
+}  // namespace Arena
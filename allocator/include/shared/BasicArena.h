@@ -2,20 +2,30 @@
 
 #include <algorithm>
 #include <cstddef>
-#include <iostream>
+#include <cstdint>
 #include <memory>
 
+#include "shared/ArenaFallback.h"
+#include "shared/ArenaStats.h"
+#include "shared/PageAllocation.h"
+
 namespace Arena {
-constexpr size_t max_alignment = alignof(std::max_align_t);
 
-// T is the capacity in bytes of the arena
-template <size_t T>
+// T is the capacity in bytes of the arena, Stats is the stats policy
+// (NoArenaStats or ArenaStats, see ArenaStats.h) and Fallback decides what
+// happens once the arena is full (HeapFallback, ThrowFallback, NullFallback
+// or CallbackFallback, see ArenaFallback.h)
+template <size_t T, typename Stats = NoArenaStats,
+          typename Fallback = HeapFallback>
 // Basic Arena is a pool that allocates a stack-like memory region on the Heap
 // It allocates memory always to the end of the region, and only reclaims memory
 // if the de-allocated memory is at the end of the region (like a stack).
 //
 // It is alignment aware and will pad data accordingly. Due to the design, extra
 // bytes used for padding may not be reclaimed.
+//
+// Large arenas can be backed by mmap'd pages instead (optionally huge and/or
+// pre-faulted), see BasicArena(const PageOptions&).
 
 // Yeah, it is a pretty dumb implementation (just for learning purposes).
 class BasicArena {
@@ -26,8 +36,25 @@ class BasicArena {
     _ptr = _buffer;
   };
 
+  // Backs the arena with anonymous mmap'd pages instead of the heap, so big
+  // arenas can use huge pages and be pre-faulted before the hot path touches
+  // them. Falls back to the heap if the mapping fails.
+  explicit BasicArena(const PageOptions& options) noexcept {
+    _buffer = static_cast<std::byte*>(mapPages(T, options));
+    if (_buffer) {
+      _mappedSize = mappedSize(T, options);
+    } else {
+      _buffer = new (std::align_val_t(max_alignment)) std::byte[T];
+    }
+    _ptr = _buffer;
+  }
+
   ~BasicArena() {
-    delete[] _buffer;
+    if (_mappedSize) {
+      unmapPages(_buffer, _mappedSize);
+    } else {
+      ::operator delete[](_buffer, std::align_val_t(max_alignment));
+    }
     _ptr = nullptr;
     _buffer = nullptr;
   }
@@ -46,55 +73,39 @@ class BasicArena {
   BasicArena(BasicArena&&) = delete;  // Delete Move constructor
 
   // Allocates s bytes according to the given alignment
-  // Fall-backs to heap allocation if there is insufficient space
-  // or errors
+  // Hands over to the Fallback policy if there is insufficient space
   void* allocate(size_t s, size_t align) {
-    if (available_size() == 0ul) {
-      std::cout << "Buffer available size is zero\n";
-      return static_cast<void*>(::operator new(s));
-    }
-
-    // Copy the pointer
-    // Use reinterpret_cast as static_cast from byte* to void*
-    // is invalid
-    auto* obj = reinterpret_cast<void*>(_ptr);
-    auto sz = available_size();
-    // Align the obj pointer
-    obj = std::align(align, s, obj, sz);
-
-    // Fail to align/out of space, default to malloc
-    if (obj == nullptr) {
-      std::cout << "Align failed - nullptr, allocating on Heap instead\n";
-      return static_cast<void*>(::operator new(s));
-    }
-
-    // Cast to byte
-    auto* obj_byte_ptr = reinterpret_cast<std::byte*>(obj);
-
-    // This is technically not necessary because std::align
-    // accounts for insufficient space
-    if (!in_buffer(obj_byte_ptr + s - 1)) {
-      std::cout << "Ran out of space in buffer\n";
-      return static_cast<void*>(::operator new(s));
+    // Align the pointer by hand, std::align does more work than we need
+    // (align must be a power of two)
+    auto addr = reinterpret_cast<std::uintptr_t>(_ptr);
+    auto aligned = (addr + align - 1) & ~(align - 1);
+    auto end = reinterpret_cast<std::uintptr_t>(_buffer + T);
+
+    // Out of space, kept out of line so the fast path stays a bump. Compared
+    // against what is left rather than as aligned + s, which a huge s wraps
+    if (aligned < addr || aligned > end || s > end - aligned) [[unlikely]] {
+      return allocateFallback(s, align);
     }
 
     // Okay, advance the pointer
-    _ptr = obj_byte_ptr + s;
-    return obj_byte_ptr;
+    auto* obj = reinterpret_cast<std::byte*>(aligned);
+    _stats.onAllocate(s, obj - _ptr);
+    _ptr = obj + s;
+    return obj;
   }
 
   // No align specified, default to max alignment
   // Just inline-it
-  inline void* allocate(size_t s) noexcept {
-    return allocate(std::move(s), max_alignment);
-  }
+  inline void* allocate(size_t s) { return allocate(s, max_alignment); }
 
   // If ptr is at end of region (stack-like), move back ptr to reclaim
   // WARNING: Does not reclaim space due to alignment
-  void deallocate(std::byte* ptr, size_t x) noexcept {
-    // If it is not in the buffer, simply call global delete
-    if (!in_buffer(ptr)) {
-      delete ptr;
+  void deallocate(std::byte* ptr, size_t x,
+                  size_t align = max_alignment) noexcept {
+    // If it is not in the buffer, it came from the Fallback policy
+    if (!in_buffer(ptr)) [[unlikely]] {
+      _stats.onDeallocate(0);
+      Fallback::deallocate(ptr, x, align);
       return;
     }
 
@@ -102,9 +113,28 @@ class BasicArena {
     if ((ptr + x) == _ptr) {
       // Move the curr _ptr back
       _ptr = ptr;
+      _stats.onDeallocate(x);
+    } else {
+      _stats.onDeallocate(0);
     }
   }
 
+  // Checkpoint of the bump pointer, see mark() and rollback()
+  struct Marker {
+    std::byte* ptr;
+  };
+
+  // Captures the current top of the arena
+  Marker mark() noexcept { return Marker{_ptr}; }
+
+  // Releases everything allocated after the marker was taken in one step.
+  // Markers must be rolled back in reverse order of being taken (like a stack)
+  // WARNING: Heap fall-backs made after the marker are not released
+  void rollback(Marker marker) noexcept {
+    _stats.onRelease(_ptr - marker.ptr);
+    _ptr = marker.ptr;
+  }
+
   bool in_buffer(std::byte* test) noexcept {
     // The book uses std::uintptr_t, but I think std::byte is OK
     // according to below:
@@ -118,11 +148,26 @@ class BasicArena {
 
   size_t used() { return _ptr - _buffer; }
 
+  // Whatever the stats policy recorded so far
+  const Stats& stats() const noexcept { return _stats; }
+
+  // Whether the buffer is mmap'd (as opposed to on the heap)
+  bool is_mapped() const noexcept { return _mappedSize != 0; }
+
  private:
+  [[gnu::cold, gnu::noinline]] void* allocateFallback(size_t s, size_t align) {
+    _stats.onFallback(s);
+    return Fallback::allocate(s, align);
+  }
+
   // Pointer to start of the buffer
   std::byte* _buffer;
   // Pointer to next available location in buffer
   std::byte* _ptr;
+  // Bytes mapped for the buffer, 0 if it lives on the heap
+  size_t _mappedSize = 0;
+  // Takes no space with NoArenaStats
+  [[no_unique_address]] Stats _stats;
 };
 
 }  // namespace Arena
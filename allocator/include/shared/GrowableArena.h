@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "shared/BasicArena.h"
+
+namespace Arena {
+
+// InitialBlockSize is the capacity in bytes of the first block
+template <size_t InitialBlockSize = 4096>
+// Growable Arena is a chain of blocks allocated on the Heap. Like BasicArena
+// it bump-allocates from the end of the current block and only reclaims
+// memory that is freed from the top (like a stack).
+//
+// Once the current block is full it moves on to the next block in the chain,
+// appending a new block twice the size of the last one (or big enough for the
+// request, whichever is larger) when it reaches the end. Nothing is ever
+// handed out from the global heap directly.
+//
+// reset() rewinds to the first block in O(1) and keeps every block, so the
+// next cycle re-uses the same memory. release() hands the blocks back.
+class GrowableArena {
+  static_assert(InitialBlockSize > 0, "InitialBlockSize must not be zero");
+
+  // Lives at the start of every block, the data follows it
+  struct Block {
+    Block* next;
+    size_t size;
+  };
+
+  static constexpr size_t header_size =
+      (sizeof(Block) + max_alignment - 1) & ~(max_alignment - 1);
+
+ public:
+  GrowableArena() noexcept = default;
+
+  ~GrowableArena() { release(); }
+
+  // Cannot be copied or moved, handed out pointers refer into its blocks
+  GrowableArena(const GrowableArena&) = delete;
+  GrowableArena& operator=(const GrowableArena&) = delete;
+  GrowableArena(GrowableArena&&) = delete;
+  GrowableArena& operator=(GrowableArena&&) = delete;
+
+  // Allocates s bytes according to the given alignment, chaining on a new
+  // block if none of the retained ones has room
+  void* allocate(size_t s, size_t align) {
+    if (auto* obj = bump(s, align)) [[likely]] {
+      return obj;
+    }
+    return allocateFromNextBlock(s, align);
+  }
+
+  // No align specified, default to max alignment
+  inline void* allocate(size_t s) { return allocate(s, max_alignment); }
+
+  // If ptr is at the top of the current block (stack-like), move back the
+  // pointer to reclaim it
+  // WARNING: Does not reclaim space due to alignment
+  void deallocate(std::byte* ptr, size_t x) noexcept {
+    if (ptr + x == _ptr) _ptr = ptr;
+  }
+
+  // Rewinds to the first block, keeping all blocks for the next cycle
+  void reset() noexcept {
+    _current = _head;
+    _ptr = _current ? dataStart(_current) : nullptr;
+    _usedBefore = 0;
+  }
+
+  // Gives every block back to the heap
+  void release() noexcept {
+    Block* block = _head;
+    while (block) {
+      Block* next = block->next;
+      ::operator delete(static_cast<void*>(block),
+                        std::align_val_t(max_alignment));
+      block = next;
+    }
+    _head = _tail = _current = nullptr;
+    _ptr = nullptr;
+    _usedBefore = 0;
+  }
+
+  // Checkpoint of the current block and bump pointer, see mark() and
+  // rollback()
+  struct Marker {
+    Block* block;
+    std::byte* ptr;
+    size_t usedBefore;
+  };
+
+  // Captures the current top of the arena
+  Marker mark() noexcept { return Marker{_current, _ptr, _usedBefore}; }
+
+  // Releases everything allocated after the marker was taken in one step,
+  // blocks chained on since then are kept for re-use. Markers must be rolled
+  // back in reverse order of being taken (like a stack)
+  void rollback(Marker marker) noexcept {
+    // Taken before the first block existed, nothing was allocated back then
+    if (!marker.block) {
+      reset();
+      return;
+    }
+    _current = marker.block;
+    _ptr = marker.ptr;
+    _usedBefore = marker.usedBefore;
+  }
+
+  bool in_buffer(std::byte* test) noexcept {
+    for (Block* block = _head; block; block = block->next) {
+      if (test >= dataStart(block) && test < dataEnd(block)) return true;
+    }
+    return false;
+  }
+
+  // Total bytes held across all blocks
+  size_t capacity() noexcept {
+    size_t total = 0;
+    for (Block* block = _head; block; block = block->next) total += block->size;
+    return total;
+  }
+
+  // Bytes left in the current block
+  size_t available_size() noexcept {
+    return _current ? static_cast<size_t>(dataEnd(_current) - _ptr) : 0;
+  }
+
+  // Bytes consumed since the last reset, including padding and the unused
+  // tails of blocks that were skipped over
+  size_t used() noexcept {
+    return _current ? _usedBefore + (_ptr - dataStart(_current)) : 0;
+  }
+
+  size_t block_count() noexcept {
+    size_t count = 0;
+    for (Block* block = _head; block; block = block->next) count++;
+    return count;
+  }
+
+ private:
+  static std::byte* dataStart(Block* block) noexcept {
+    return reinterpret_cast<std::byte*>(block) + header_size;
+  }
+
+  static std::byte* dataEnd(Block* block) noexcept {
+    return dataStart(block) + block->size;
+  }
+
+  // Align-and-bump within the current block, nullptr if it does not fit
+  std::byte* bump(size_t s, size_t align) noexcept {
+    if (!_current) return nullptr;
+    auto addr = reinterpret_cast<std::uintptr_t>(_ptr);
+    auto* obj =
+        reinterpret_cast<std::byte*>((addr + align - 1) & ~(align - 1));
+    if (obj + s > dataEnd(_current)) return nullptr;
+    _ptr = obj + s;
+    return obj;
+  }
+
+  [[gnu::noinline]] void* allocateFromNextBlock(size_t s, size_t align) {
+    // Walk the blocks retained from previous cycles first
+    while (_current && _current->next) {
+      advanceTo(_current->next);
+      if (auto* obj = bump(s, align)) return obj;
+    }
+
+    // Worst case padding is (align - 1) as blocks are max_alignment aligned
+    size_t needed = s + (align > max_alignment ? align - 1 : 0);
+    size_t size = _tail ? _tail->size * 2 : InitialBlockSize;
+    size = std::max(size, needed);
+
+    void* memory = ::operator new(header_size + size,
+                                  std::align_val_t(max_alignment));
+    auto* block = new (memory) Block{nullptr, size};
+    if (_tail) {
+      _tail->next = block;
+    } else {
+      _head = block;
+    }
+    _tail = block;
+    advanceTo(block);
+    return bump(s, align);
+  }
+
+  void advanceTo(Block* block) noexcept {
+    if (_current) _usedBefore += _current->size;
+    _current = block;
+    _ptr = dataStart(block);
+  }
+
+  // First and last block in the chain
+  Block* _head = nullptr;
+  Block* _tail = nullptr;
+  // Block currently being bumped from
+  Block* _current = nullptr;
+  // Pointer to next available location in the current block
+  std::byte* _ptr = nullptr;
+  // Capacity of the blocks before the current one since the last reset
+  size_t _usedBefore = 0;
+};
+
+}  // namespace Arena
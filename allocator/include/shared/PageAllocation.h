@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Arena {
+
+// How to map the pages backing an arena, see BasicArena(const PageOptions&)
+struct PageOptions {
+  // Ask for 2MB huge pages (MAP_HUGETLB), falling back to transparent huge
+  // pages (madvise(MADV_HUGEPAGE)) when none are reserved. Fewer TLB misses
+  // for big arenas.
+  bool hugePages = false;
+  // Pre-fault every page up front (MAP_POPULATE) instead of on first touch.
+  // Pages land on the NUMA node of the thread creating the arena.
+  bool populate = false;
+};
+
+// Number of bytes actually mapped for a request of bytes, rounded up to the
+// (huge) page size
+size_t mappedSize(size_t bytes, const PageOptions& options) noexcept;
+
+// Maps anonymous, private, read-write memory of mappedSize(bytes, options)
+// bytes. Returns nullptr if the mapping fails.
+void* mapPages(size_t bytes, const PageOptions& options) noexcept;
+
+// Unmaps memory returned by mapPages(), mapped is its mappedSize()
+void unmapPages(void* ptr, size_t mapped) noexcept;
+
+}  // namespace Arena
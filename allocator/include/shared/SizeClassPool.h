@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <new>
+
+#include "shared/ArenaStats.h"
+#include "shared/BasicArena.h"
+
+namespace Arena {
+
+// MaxBlockSize is the largest size class in bytes, SlabSize the number of
+// bytes carved into blocks at a time. Both must be powers of two. Stats is
+// the stats policy (NoArenaStats or ArenaStats, see ArenaStats.h)
+template <size_t MaxBlockSize = 1024, size_t SlabSize = 64 * 1024,
+          typename Stats = NoArenaStats>
+// Size Class Pool segregates allocations into power-of-two size classes, each
+// with its own intrusive free list. Unlike the arenas, blocks can be allocated
+// and freed in any order in O(1), and a freed block is immediately re-used by
+// the next allocation of the same class.
+//
+// Blocks are carved out of slabs that are aligned to MaxBlockSize, so a block
+// of class 2^k is always 2^k aligned. Requests bigger than MaxBlockSize go to
+// the heap. Slabs are only returned to the heap when the pool is destroyed.
+//
+// The same size and alignment must be passed to deallocate() as to
+// allocate(), like std::pmr::memory_resource.
+class SizeClassPool {
+  static_assert(std::has_single_bit(MaxBlockSize),
+                "MaxBlockSize must be a power of two");
+  static_assert(std::has_single_bit(SlabSize),
+                "SlabSize must be a power of two");
+  static_assert(SlabSize >= 2 * MaxBlockSize,
+                "SlabSize must fit at least two of the largest blocks");
+
+  // Stored inside a block while it sits on a free list
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  // Slabs are chained through their first block so they can be released
+  struct Slab {
+    Slab* next;
+  };
+
+ public:
+  static constexpr size_t min_block_size = sizeof(FreeNode);
+  static constexpr size_t class_count =
+      std::bit_width(MaxBlockSize) - std::bit_width(min_block_size) + 1;
+
+  SizeClassPool() noexcept = default;
+
+  ~SizeClassPool() {
+    Slab* slab = _slabs;
+    while (slab) {
+      Slab* next = slab->next;
+      ::operator delete(static_cast<void*>(slab),
+                        std::align_val_t(MaxBlockSize));
+      slab = next;
+    }
+  }
+
+  // Cannot be copied or moved, handed out pointers refer into its slabs
+  SizeClassPool(const SizeClassPool&) = delete;
+  SizeClassPool& operator=(const SizeClassPool&) = delete;
+  SizeClassPool(SizeClassPool&&) = delete;
+  SizeClassPool& operator=(SizeClassPool&&) = delete;
+
+  // Allocates s bytes according to the given alignment from the matching
+  // size class, falls back to heap allocation above MaxBlockSize
+  void* allocate(size_t s, size_t align) {
+    if (!is_pooled(s, align)) [[unlikely]] {
+      _stats.onFallback(s);
+      return ::operator new(s, std::align_val_t(align));
+    }
+
+    const size_t index = class_index(s, align);
+    _stats.onAllocate(s, block_size(s, align) - s);
+    if (FreeNode* node = _freeLists[index]) [[likely]] {
+      _freeLists[index] = node->next;
+      return node;
+    }
+    return refillAndAllocate(index);
+  }
+
+  // No align specified, default to max alignment
+  inline void* allocate(size_t s) { return allocate(s, max_alignment); }
+
+  // Pushes the block back onto the free list of its size class
+  void deallocate(std::byte* ptr, size_t s, size_t align) noexcept {
+    if (!is_pooled(s, align)) [[unlikely]] {
+      _stats.onDeallocate(0);
+      ::operator delete(static_cast<void*>(ptr), std::align_val_t(align));
+      return;
+    }
+
+    const size_t index = class_index(s, align);
+    _stats.onDeallocate(block_size(s, align));
+    _freeLists[index] = new (ptr) FreeNode{_freeLists[index]};
+  }
+
+  // No align specified, default to max alignment
+  inline void deallocate(std::byte* ptr, size_t s) noexcept {
+    deallocate(ptr, s, max_alignment);
+  }
+
+  // Whether a request is served from a size class (instead of the heap)
+  static constexpr bool is_pooled(size_t s, size_t align) noexcept {
+    return std::max(s, align) <= MaxBlockSize;
+  }
+
+  // Size in bytes of the block handed out for a request
+  static constexpr size_t block_size(size_t s, size_t align) noexcept {
+    return std::bit_ceil(std::max({s, align, min_block_size}));
+  }
+
+  // Number of free blocks currently waiting in the class serving s bytes
+  size_t free_count(size_t s, size_t align = max_alignment) const noexcept {
+    size_t count = 0;
+    for (auto* node = _freeLists[class_index(s, align)]; node;
+         node = node->next) {
+      count++;
+    }
+    return count;
+  }
+
+  // Whatever the stats policy recorded so far
+  const Stats& stats() const noexcept { return _stats; }
+
+  size_t slab_count() const noexcept {
+    size_t count = 0;
+    for (Slab* slab = _slabs; slab; slab = slab->next) count++;
+    return count;
+  }
+
+ private:
+  static constexpr size_t class_index(size_t s, size_t align) noexcept {
+    return std::bit_width(block_size(s, align)) -
+           std::bit_width(min_block_size);
+  }
+
+  // Carves a fresh slab into blocks of one class and threads them onto the
+  // free list. The first block of every slab holds the slab chain.
+  [[gnu::noinline]] void* refillAndAllocate(size_t index) {
+    const size_t blockSize = min_block_size << index;
+    auto* memory = static_cast<std::byte*>(
+        ::operator new(SlabSize, std::align_val_t(MaxBlockSize)));
+    _slabs = new (memory) Slab{_slabs};
+
+    // Threaded back to front, so blocks are handed out in address order
+    const size_t first = blockSize;
+    FreeNode* head = nullptr;
+    for (size_t offset = SlabSize - blockSize; offset > first;
+         offset -= blockSize) {
+      head = new (memory + offset) FreeNode{head};
+    }
+    _freeLists[index] = head;
+    return memory + first;
+  }
+
+  std::array<FreeNode*, class_count> _freeLists{};
+  Slab* _slabs = nullptr;
+  // Takes no space with NoArenaStats
+  [[no_unique_address]] Stats _stats;
+};
+
+}  // namespace Arena
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "shared/BasicArena.h"
+
+namespace Arena {
+
+namespace detail {
+// Every ThreadCachingArena gets a process-unique id, so a thread-local cache
+// entry can never be mistaken for a later arena living at the same address
+std::uint64_t nextThreadCachingArenaId() noexcept;
+
+// Per-thread state of a ThreadCachingArena, owned jointly by the arena and
+// the thread using it. Whichever lets go last frees it.
+struct ThreadSlot {
+  // Thread currently owning the slot, a default id once it is orphaned
+  std::atomic<std::thread::id> thread;
+  // Set when the owning thread exits, the next new thread adopts the slot
+  std::atomic<bool> orphaned{false};
+  std::atomic<int> owners{2};
+
+  explicit ThreadSlot(std::thread::id self) noexcept : thread(self) {}
+  virtual ~ThreadSlot() = default;
+
+  void release() noexcept {
+    if (owners.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+  }
+};
+
+// Makes room for one more slot in the calling thread's exit list, so the
+// orphanOnThreadExit() call that follows can't fail
+void reserveOrphanOnThreadExit();
+
+// Orphans (and releases) slot when the calling thread exits
+void orphanOnThreadExit(ThreadSlot* slot) noexcept;
+}  // namespace detail
+
+// ChunkSize is the size in bytes of each per-thread chunk (a power of two)
+template <size_t ChunkSize = 64 * 1024>
+// Thread Caching Arena hands every thread its own chunk to bump-allocate from,
+// so allocate() never takes a lock and never touches the global heap once the
+// thread owns a chunk.
+//
+// Chunks are aligned to ChunkSize, so the owning chunk of any pointer is found
+// by masking off the low bits. A free from the owning thread is handled
+// in-place (stack-like reclaim + live count), while a free from any other
+// thread is pushed onto the chunk's lock-free return list. The owning thread
+// drains its return lists on its slow path (or via drain()), and a chunk whose
+// live count drops to zero is reset and bumped from again.
+//
+// Requests larger than a quarter of a chunk, or aligned beyond max_alignment,
+// go straight to the heap so one large block cannot strand a mostly empty
+// chunk. All chunks are released together when the arena is destroyed.
+//
+// When a thread exits, its chunks are orphaned rather than lost, and the next
+// thread to touch the arena adopts them (draining whatever was freed to them
+// in the meantime), so thread churn doesn't grow the arena.
+class ThreadCachingArena {
+  static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+                "ChunkSize must be a power of two");
+
+  // Written into a block when it is freed by a foreign thread
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct Slot;
+
+  // Lives at the start of every ChunkSize-aligned chunk
+  struct Chunk {
+    Slot* owner;
+    Chunk* nextOwned;
+    // Pushed to by foreign threads, drained by the owner
+    std::atomic<FreeNode*> remoteFrees{nullptr};
+    // Only ever touched by the owning thread
+    size_t live = 0;
+    std::byte* ptr;
+  };
+
+  // Per-thread state, created on the first allocation of a thread
+  struct Slot : detail::ThreadSlot {
+    Chunk* active = nullptr;
+    Chunk* chunks = nullptr;
+    Slot* next = nullptr;
+
+    using detail::ThreadSlot::ThreadSlot;
+  };
+
+  struct CacheEntry {
+    std::uint64_t arenaId = 0;
+    Slot* slot = nullptr;
+  };
+
+  static constexpr size_t header_size =
+      (sizeof(Chunk) + max_alignment - 1) & ~(max_alignment - 1);
+  static_assert(ChunkSize > header_size * 2, "ChunkSize is too small");
+
+ public:
+  static constexpr size_t chunk_capacity = ChunkSize - header_size;
+  static constexpr size_t max_chunked_size = chunk_capacity / 4;
+
+  ThreadCachingArena() noexcept : _id(detail::nextThreadCachingArenaId()) {}
+
+  ~ThreadCachingArena() {
+    Slot* slot = _slots;
+    while (slot) {
+      Chunk* chunk = slot->chunks;
+      while (chunk) {
+        Chunk* next = chunk->nextOwned;
+        chunk->~Chunk();
+        ::operator delete(static_cast<void*>(chunk),
+                          std::align_val_t(ChunkSize));
+        chunk = next;
+      }
+      slot->chunks = slot->active = nullptr;
+      Slot* next = slot->next;
+      // The owning thread may still be alive, it frees the slot on exit
+      slot->release();
+      slot = next;
+    }
+  }
+
+  // Arena is shared by reference between threads, it is never copied or moved
+  ThreadCachingArena(const ThreadCachingArena&) = delete;
+  ThreadCachingArena& operator=(const ThreadCachingArena&) = delete;
+  ThreadCachingArena(ThreadCachingArena&&) = delete;
+  ThreadCachingArena& operator=(ThreadCachingArena&&) = delete;
+
+  // Allocates s bytes according to the given alignment from the calling
+  // thread's chunk. Safe to call concurrently from any number of threads.
+  void* allocate(size_t s, size_t align = max_alignment) {
+    normalize(s, align);
+    if (!is_chunked(s, align)) [[unlikely]] {
+      return heapAllocate(s, align);
+    }
+
+    Slot* slot = localSlot();
+    Chunk* chunk = slot->active;
+    if (chunk) [[likely]] {
+      if (auto* obj = bump(chunk, s, align)) return obj;
+    }
+    return refillAndAllocate(slot, s, align);
+  }
+
+  // Frees memory obtained from allocate() with the same size and alignment.
+  // May be called from any thread, not only the one that allocated.
+  void deallocate(std::byte* ptr, size_t s,
+                  size_t align = max_alignment) noexcept {
+    normalize(s, align);
+    if (!is_chunked(s, align)) [[unlikely]] {
+      heapDeallocate(ptr, align);
+      return;
+    }
+
+    // Compare thread ids, so a free-only thread never needs a slot of its own
+    Chunk* chunk = chunkOf(ptr);
+    if (chunk->owner->thread.load(std::memory_order_relaxed) ==
+        std::this_thread::get_id()) {
+      // Owning thread, reclaim in place
+      if (ptr + s == chunk->ptr) chunk->ptr = ptr;
+      if (--chunk->live == 0) chunk->ptr = dataStart(chunk);
+      return;
+    }
+
+    // Foreign thread, hand it back through the lock-free return list
+    auto* node = new (ptr)
+        FreeNode{chunk->remoteFrees.load(std::memory_order_relaxed)};
+    while (!chunk->remoteFrees.compare_exchange_weak(
+        node->next, node, std::memory_order_release,
+        std::memory_order_relaxed)) {
+    }
+  }
+
+  // Reclaims everything other threads have freed back to the calling thread's
+  // chunks. Called automatically when the active chunk runs out of space.
+  void drain() noexcept {
+    Slot* slot = localSlot();
+    for (Chunk* chunk = slot->chunks; chunk; chunk = chunk->nextOwned) {
+      drainChunk(chunk);
+    }
+  }
+
+  // Whether a request of s bytes with the given alignment is served from a
+  // chunk (as opposed to falling back to the heap)
+  static constexpr bool is_chunked(size_t s, size_t align) noexcept {
+    return s <= max_chunked_size && align <= max_alignment;
+  }
+
+  // Bytes bumped so far in the calling thread's active chunk
+  size_t local_used() noexcept {
+    Chunk* chunk = localSlot()->active;
+    return chunk ? static_cast<size_t>(chunk->ptr - dataStart(chunk)) : 0;
+  }
+
+  // Number of chunks owned by the calling thread
+  size_t local_chunk_count() noexcept {
+    size_t count = 0;
+    Chunk* chunk = localSlot()->chunks;
+    for (; chunk; chunk = chunk->nextOwned) count++;
+    return count;
+  }
+
+  // Number of chunks owned by all threads, live or exited
+  size_t chunk_count() {
+    std::lock_guard<std::mutex> lock(_slotsMutex);
+    size_t count = 0;
+    for (Slot* slot = _slots; slot; slot = slot->next) {
+      for (Chunk* chunk = slot->chunks; chunk; chunk = chunk->nextOwned) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+ private:
+  // Every block must be able to hold a FreeNode once it is freed remotely
+  static constexpr void normalize(size_t& s, size_t& align) noexcept {
+    s = std::max(s, sizeof(FreeNode));
+    align = std::max(align, alignof(FreeNode));
+  }
+
+  static Chunk* chunkOf(std::byte* ptr) noexcept {
+    return reinterpret_cast<Chunk*>(reinterpret_cast<std::uintptr_t>(ptr) &
+                                    ~(std::uintptr_t(ChunkSize) - 1));
+  }
+
+  static std::byte* dataStart(Chunk* chunk) noexcept {
+    return reinterpret_cast<std::byte*>(chunk) + header_size;
+  }
+
+  static std::byte* dataEnd(Chunk* chunk) noexcept {
+    return reinterpret_cast<std::byte*>(chunk) + ChunkSize;
+  }
+
+  static std::byte* bump(Chunk* chunk, size_t s, size_t align) noexcept {
+    auto addr = reinterpret_cast<std::uintptr_t>(chunk->ptr);
+    auto* obj =
+        reinterpret_cast<std::byte*>((addr + align - 1) & ~(align - 1));
+    if (obj + s > dataEnd(chunk)) return nullptr;
+    chunk->ptr = obj + s;
+    chunk->live++;
+    return obj;
+  }
+
+  static void drainChunk(Chunk* chunk) noexcept {
+    FreeNode* node =
+        chunk->remoteFrees.exchange(nullptr, std::memory_order_acquire);
+    if (!node) return;
+    size_t count = 0;
+    for (; node; node = node->next) count++;
+    chunk->live -= count;
+    if (chunk->live == 0) chunk->ptr = dataStart(chunk);
+  }
+
+  Slot* localSlot() {
+    if (_cache.arenaId == _id) [[likely]] {
+      return _cache.slot;
+    }
+    return lookupSlot();
+  }
+
+  // Only taken the first time a thread touches this arena (or when it
+  // switches between arenas), never on the steady-state allocate path
+  [[gnu::noinline]] Slot* lookupSlot() {
+    std::lock_guard<std::mutex> lock(_slotsMutex);
+    auto self = std::this_thread::get_id();
+    Slot* slot = _slots;
+    while (slot && slot->thread.load(std::memory_order_relaxed) != self) {
+      slot = slot->next;
+    }
+
+    // New thread, take over the chunks of an exited one if there is one.
+    // Whatever can throw happens before a slot is registered to this thread
+    if (!slot) {
+      detail::reserveOrphanOnThreadExit();
+      slot = _slots;
+      while (slot && !slot->orphaned.load(std::memory_order_acquire)) {
+        slot = slot->next;
+      }
+      if (slot) adopt(slot, self);
+    }
+
+    if (!slot) {
+      slot = new Slot(self);
+      detail::orphanOnThreadExit(slot);
+      slot->next = _slots;
+      _slots = slot;
+    }
+    _cache = CacheEntry{_id, slot};
+    return slot;
+  }
+
+  // Takes over an orphaned slot and everything freed to its chunks
+  static void adopt(Slot* slot, std::thread::id self) noexcept {
+    slot->owners.fetch_add(1, std::memory_order_relaxed);
+    slot->orphaned.store(false, std::memory_order_relaxed);
+    slot->thread.store(self, std::memory_order_relaxed);
+    detail::orphanOnThreadExit(slot);
+    for (Chunk* chunk = slot->chunks; chunk; chunk = chunk->nextOwned) {
+      drainChunk(chunk);
+    }
+  }
+
+  [[gnu::cold, gnu::noinline]] void* refillAndAllocate(Slot* slot, size_t s,
+                                                       size_t align) {
+    // Take back whatever other threads have returned to us
+    Chunk* empty = nullptr;
+    for (Chunk* chunk = slot->chunks; chunk; chunk = chunk->nextOwned) {
+      drainChunk(chunk);
+      if (chunk->live == 0 && !empty) empty = chunk;
+    }
+    if (slot->active) {
+      if (auto* obj = bump(slot->active, s, align)) return obj;
+    }
+
+    // Re-use a drained chunk, or carve out a brand new one
+    if (!empty) {
+      void* memory = ::operator new(ChunkSize, std::align_val_t(ChunkSize));
+      empty = new (memory) Chunk{slot, slot->chunks, {nullptr}, 0,
+                                 static_cast<std::byte*>(memory) + header_size};
+      slot->chunks = empty;
+    }
+    slot->active = empty;
+    return bump(empty, s, align);
+  }
+
+  [[gnu::cold]] static void* heapAllocate(size_t s, size_t align) {
+    if (align > max_alignment) {
+      return ::operator new(s, std::align_val_t(align));
+    }
+    return ::operator new(s);
+  }
+
+  [[gnu::cold]] static void heapDeallocate(std::byte* ptr,
+                                           size_t align) noexcept {
+    if (align > max_alignment) {
+      ::operator delete(static_cast<void*>(ptr), std::align_val_t(align));
+      return;
+    }
+    ::operator delete(static_cast<void*>(ptr));
+  }
+
+  // Last arena this thread talked to, so the hot path skips the slot lookup
+  static inline thread_local CacheEntry _cache{};
+
+  const std::uint64_t _id;
+  std::mutex _slotsMutex;
+  Slot* _slots = nullptr;
+};
+
+}  // namespace Arena
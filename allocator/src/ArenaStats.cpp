@@ -0,0 +1,44 @@
+#include "shared/ArenaStats.h"
+
+#include <string>
+
+namespace Arena {
+
+std::string ArenaStats::toJson() const {
+  std::string json = "{";
+  auto field = [&json](const char* name, size_t value) {
+    json += '"';
+    json += name;
+    json += "\":";
+    json += std::to_string(value);
+    json += ',';
+  };
+  field("allocations", _allocations);
+  field("deallocations", _deallocations);
+  field("bytes_requested", _bytesRequested);
+  field("bytes_padding", _bytesPadding);
+  field("fallbacks", _fallbacks);
+  field("fallback_bytes", _fallbackBytes);
+  field("in_use", _inUse);
+  field("high_water_mark", _highWaterMark);
+
+  // Only the buckets that saw a request, "le" is null for the overflow bucket
+  json += "\"size_histogram\":[";
+  bool first = true;
+  for (size_t i = 0; i < histogram_buckets; i++) {
+    if (_histogram[i] == 0) continue;
+    if (!first) json += ',';
+    first = false;
+    json += "{\"le\":";
+    json += i + 1 < histogram_buckets
+                ? std::to_string(bucket_upper_bound(i))
+                : std::string("null");
+    json += ",\"count\":";
+    json += std::to_string(_histogram[i]);
+    json += '}';
+  }
+  json += "]}";
+  return json;
+}
+
+}  // namespace Arena
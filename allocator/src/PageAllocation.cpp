@@ -0,0 +1,44 @@
+#include "shared/PageAllocation.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Arena {
+
+namespace {
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+size_t roundUp(size_t bytes, size_t multiple) noexcept {
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+}  // namespace
+
+size_t mappedSize(size_t bytes, const PageOptions& options) noexcept {
+  static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return roundUp(bytes == 0 ? 1 : bytes,
+                 options.hugePages ? huge_page_size : pageSize);
+}
+
+void* mapPages(size_t bytes, const PageOptions& options) noexcept {
+  const size_t size = mappedSize(bytes, options);
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (options.populate) flags |= MAP_POPULATE;
+
+  if (options.hugePages) {
+    // Only succeeds if huge pages were reserved (vm.nr_hugepages)
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     flags | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) return ptr;
+  }
+
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (ptr == MAP_FAILED) return nullptr;
+
+  // Best effort, transparent huge pages may be disabled altogether
+  if (options.hugePages) madvise(ptr, size, MADV_HUGEPAGE);
+  return ptr;
+}
+
+void unmapPages(void* ptr, size_t mapped) noexcept { munmap(ptr, mapped); }
+
+}  // namespace Arena
@@ -0,0 +1,47 @@
+#include "shared/ThreadCachingArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace Arena::detail {
+
+std::uint64_t nextThreadCachingArenaId() noexcept {
+  // Start at 1, a zeroed thread-local cache entry must never match an arena
+  static std::atomic<std::uint64_t> nextId{1};
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+// Slots of every arena the thread used, orphaned when the thread exits
+struct ThreadExitOrphaner {
+  std::vector<ThreadSlot*> slots;
+
+  ~ThreadExitOrphaner() {
+    for (auto* slot : slots) {
+      slot->thread.store(std::thread::id(), std::memory_order_relaxed);
+      slot->orphaned.store(true, std::memory_order_release);
+      slot->release();
+    }
+  }
+};
+
+ThreadExitOrphaner& threadExitOrphaner() {
+  thread_local ThreadExitOrphaner orphaner;
+  return orphaner;
+}
+}  // namespace
+
+void reserveOrphanOnThreadExit() {
+  auto& slots = threadExitOrphaner().slots;
+  if (slots.size() == slots.capacity()) {
+    slots.reserve(std::max<size_t>(4, 2 * slots.capacity()));
+  }
+}
+
+void orphanOnThreadExit(ThreadSlot* slot) noexcept {
+  // Room was reserved beforehand, this push_back doesn't allocate
+  threadExitOrphaner().slots.push_back(slot);
+}
+
+}  // namespace Arena::detail
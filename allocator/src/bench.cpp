@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#include "shared/BasicArena.h"
+#include "shared/GrowableArena.h"
+#include "shared/SizeClassPool.h"
+#include "shared/ThreadCachingArena.h"
+
+// Every benchmark allocates a batch of blocks, touches them and then releases
+// the whole batch the way that allocator would in a request handler (free
+// each block, rollback, reset, ...). Arguments are {size, alignment}.
+//
+// Run with eg. --benchmark_filter=BasicArena --benchmark_counters_tabular=true
+
+namespace {
+
+constexpr size_t batch = 64;
+
+/* Allocators under test, each one is created once per benchmark thread */
+
+struct Malloc {
+  void* allocate(size_t s, size_t align) {
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return align > Arena::max_alignment
+               ? std::aligned_alloc(align, (s + align - 1) & ~(align - 1))
+               : std::malloc(s);
+  }
+  void release(std::array<void*, batch>& ptrs, size_t, size_t) {
+    for (auto* p : ptrs) std::free(p);
+  }
+};
+
+struct GlobalNew {
+  void* allocate(size_t s, size_t align) {
+    return ::operator new(s, std::align_val_t(align));
+  }
+  void release(std::array<void*, batch>& ptrs, size_t, size_t align) {
+    for (auto* p : ptrs) ::operator delete(p, std::align_val_t(align));
+  }
+};
+
+struct BasicArenaBench {
+  Arena::BasicArena<1 << 20> arena;
+  decltype(arena)::Marker start = arena.mark();
+  void* allocate(size_t s, size_t align) { return arena.allocate(s, align); }
+  void release(std::array<void*, batch>&, size_t, size_t) {
+    arena.rollback(start);
+  }
+};
+
+struct GrowableArenaBench {
+  Arena::GrowableArena<64 * 1024> arena;
+  void* allocate(size_t s, size_t align) { return arena.allocate(s, align); }
+  void release(std::array<void*, batch>&, size_t, size_t) { arena.reset(); }
+};
+
+struct SizeClassPoolBench {
+  Arena::SizeClassPool<4096, 256 * 1024> pool;
+  void* allocate(size_t s, size_t align) { return pool.allocate(s, align); }
+  void release(std::array<void*, batch>& ptrs, size_t s, size_t align) {
+    for (auto* p : ptrs) {
+      pool.deallocate(static_cast<std::byte*>(p), s, align);
+    }
+  }
+};
+
+// Shared by every benchmark thread, that is the whole point of it
+Arena::ThreadCachingArena<256 * 1024> sharedThreadCachingArena;
+
+struct ThreadCachingArenaBench {
+  void* allocate(size_t s, size_t align) {
+    return sharedThreadCachingArena.allocate(s, align);
+  }
+  void release(std::array<void*, batch>& ptrs, size_t s, size_t align) {
+    for (auto* p : ptrs) {
+      sharedThreadCachingArena.deallocate(static_cast<std::byte*>(p), s,
+                                          align);
+    }
+  }
+};
+
+struct MonotonicBufferBench {
+  std::vector<std::byte> buffer = std::vector<std::byte>(1 << 20);
+  std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+  void* allocate(size_t s, size_t align) {
+    return resource.allocate(s, align);
+  }
+  void release(std::array<void*, batch>&, size_t, size_t) {
+    resource.release();
+  }
+};
+
+/* Benchmarks */
+
+template <typename Allocator>
+void BM_AllocateBatch(benchmark::State& state) {
+  const auto size = static_cast<size_t>(state.range(0));
+  const auto align = static_cast<size_t>(state.range(1));
+  Allocator allocator;
+  std::array<void*, batch> ptrs;
+
+  for (auto _ : state) {
+    for (auto& p : ptrs) {
+      p = allocator.allocate(size, align);
+      // Touch the first byte, like a constructor would
+      *static_cast<char*>(p) = 1;
+    }
+    benchmark::DoNotOptimize(ptrs.data());
+    allocator.release(ptrs, size, align);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.SetBytesProcessed(state.iterations() * batch * size);
+}
+
+// Cheapest back-to-back pair of steady_clock reads, ie. the floor every
+// latency sample below includes
+double clockOverheadNs() {
+  double best = 1e9;
+  for (int i = 0; i < 1000; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto stop = std::chrono::steady_clock::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::nano>(stop - start).count());
+  }
+  return best;
+}
+
+// Times every allocation on its own and reports percentiles of single
+// allocations, so one slow refill, fallback or page fault shows up in the
+// tail at full size. Each sample includes a steady_clock read, reported as
+// clock_ns
+template <typename Allocator>
+void BM_AllocateLatency(benchmark::State& state) {
+  const auto size = static_cast<size_t>(state.range(0));
+  const auto align = static_cast<size_t>(state.range(1));
+  Allocator allocator;
+  std::array<void*, batch> ptrs;
+  std::vector<double> samples;
+  samples.reserve(1 << 20);
+
+  for (auto _ : state) {
+    for (auto& p : ptrs) {
+      const auto start = std::chrono::steady_clock::now();
+      p = allocator.allocate(size, align);
+      const auto stop = std::chrono::steady_clock::now();
+      *static_cast<char*>(p) = 1;
+      if (samples.size() < samples.capacity()) {
+        samples.push_back(
+            std::chrono::duration<double, std::nano>(stop - start).count());
+      }
+    }
+    benchmark::DoNotOptimize(ptrs.data());
+    allocator.release(ptrs, size, align);
+  }
+
+  if (samples.empty()) return;
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double p) {
+    return samples[static_cast<size_t>(p * (samples.size() - 1))];
+  };
+  state.counters["p50_ns"] = percentile(0.50);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p999_ns"] = percentile(0.999);
+  state.counters["max_ns"] = samples.back();
+  state.counters["clock_ns"] = clockOverheadNs();
+}
+
+// {size, alignment}, sizes straddle the small/large boundaries of the pools
+void sizesAndAlignments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "align"});
+  for (long size : {8, 64, 512, 4096}) {
+    for (long align : {8, 64}) b->Args({size, align});
+  }
+}
+
+// Same sizes, natural alignment only. For ThreadCachingArena, which sends
+// anything aligned beyond max_alignment straight to ::operator new
+void sizesOnly(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "align"});
+  for (long size : {8, 64, 512, 4096}) b->Args({size, 8});
+}
+
+}  // namespace
+
+#define ALLOCATOR_BENCHMARKS(Allocator, Args)                  \
+  BENCHMARK_TEMPLATE(BM_AllocateBatch, Allocator)              \
+      ->Apply(Args)                                            \
+      ->Threads(1)                                             \
+      ->Threads(4)                                             \
+      ->UseRealTime();                                         \
+  BENCHMARK_TEMPLATE(BM_AllocateLatency, Allocator)->Apply(Args);
+
+ALLOCATOR_BENCHMARKS(Malloc, sizesAndAlignments)
+ALLOCATOR_BENCHMARKS(GlobalNew, sizesAndAlignments)
+ALLOCATOR_BENCHMARKS(BasicArenaBench, sizesAndAlignments)
+ALLOCATOR_BENCHMARKS(GrowableArenaBench, sizesAndAlignments)
+ALLOCATOR_BENCHMARKS(SizeClassPoolBench, sizesAndAlignments)
+ALLOCATOR_BENCHMARKS(ThreadCachingArenaBench, sizesOnly)
+ALLOCATOR_BENCHMARKS(MonotonicBufferBench, sizesAndAlignments)
+
+BENCHMARK_MAIN();
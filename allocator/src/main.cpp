@@ -1,19 +1,44 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <latch>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/ArenaAllocator.h"
+#include "shared/ArenaFallback.h"
+#include "shared/ArenaScope.h"
+#include "shared/ArenaStats.h"
 
 #include "shared/BasicAllocator.h"
 #include "shared/BasicArena.h"
+#include "shared/GrowableArena.h"
+#include "shared/PageAllocation.h"
+#include "shared/SizeClassPool.h"
+#include "shared/ThreadCachingArena.h"
+
+// Number of global heap allocations so far, from any thread
+static std::atomic<size_t> HEAP_ALLOC_COUNT = 0;
 
 // Override global new and delete
 void* operator new(size_t size) {
+  HEAP_ALLOC_COUNT.fetch_add(1, std::memory_order_relaxed);
   void* ptr = std::malloc(size);
   std::cout << "Heap Alloc: " << size << " bytes at " << ptr << "\n";
   return ptr;
 }
 
 void* operator new(std::size_t count, std::align_val_t al) {
-  void* ptr = std::malloc(count);
+  HEAP_ALLOC_COUNT.fetch_add(1, std::memory_order_relaxed);
+  // aligned_alloc wants the size to be a multiple of the alignment
+  auto align = static_cast<size_t>(al);
+  void* ptr = std::aligned_alloc(align, (count + align - 1) & ~(align - 1));
   std::cout << "Heap Alloc: " << count << " bytes at " << ptr << " with align ["
             << static_cast<size_t>(al) << "]\n";
   return ptr;
@@ -48,6 +73,46 @@ void testAllocateArenaTooSmall();
 void testAllocateAndDeallocateSingleChar();
 void testAllocateAndDeallocateManyMixed();
 
+// Tests for the thread caching arena
+void testThreadCachingArenaSameThread();
+void testThreadCachingArenaCrossThreadFree();
+void testThreadCachingArenaManyThreads();
+void testThreadCachingArenaThreadChurn();
+
+// Tests for the growable arena
+void testGrowableArenaChainsBlocks();
+void testGrowableArenaOversizedRequest();
+void testGrowableArenaResetReusesBlocks();
+
+// Tests for the std::pmr and STL allocator adapters
+void testPmrVectorNoGlobalAllocations();
+void testPmrContainersOnGrowableArena();
+void testArenaAllocatorStlContainers();
+
+// Tests for the size class pool
+void testSizeClassPoolClasses();
+void testSizeClassPoolOutOfOrderFree();
+void testSizeClassPoolOversized();
+
+// Tests for markers and scopes
+void testBasicArenaMarkerRollback();
+void testBasicArenaNestedScopes();
+void testGrowableArenaScopeAcrossBlocks();
+
+// Tests for stats instrumentation
+void testBasicArenaStats();
+void testSizeClassPoolStats();
+
+// Tests for fallback policies
+void testThrowFallback();
+void testNullFallback();
+void testCallbackFallback();
+void testHeapFallbackOverAligned();
+
+// Tests for mmap'd arenas
+void testMappedArena();
+void testMappedArenaHugePages();
+
 int main() {
   // Say hi
   BasicAllocator::printBasicAllocatorHeader();
@@ -57,6 +122,30 @@ int main() {
   testAllocateArenaTooSmall();
   testAllocateAndDeallocateSingleChar();
   testAllocateAndDeallocateManyMixed();
+  testThreadCachingArenaSameThread();
+  testThreadCachingArenaCrossThreadFree();
+  testThreadCachingArenaManyThreads();
+  testThreadCachingArenaThreadChurn();
+  testGrowableArenaChainsBlocks();
+  testGrowableArenaOversizedRequest();
+  testGrowableArenaResetReusesBlocks();
+  testPmrVectorNoGlobalAllocations();
+  testPmrContainersOnGrowableArena();
+  testArenaAllocatorStlContainers();
+  testSizeClassPoolClasses();
+  testSizeClassPoolOutOfOrderFree();
+  testSizeClassPoolOversized();
+  testBasicArenaMarkerRollback();
+  testBasicArenaNestedScopes();
+  testGrowableArenaScopeAcrossBlocks();
+  testBasicArenaStats();
+  testSizeClassPoolStats();
+  testThrowFallback();
+  testNullFallback();
+  testCallbackFallback();
+  testHeapFallbackOverAligned();
+  testMappedArena();
+  testMappedArenaHugePages();
 }
 
 void testAllocateSingleInt() {
@@ -202,3 +291,591 @@ void testAllocateAndDeallocateManyMixed() {
   a.deallocate(unsafeCastToBytePtr(c), sizeof(*c));
   assert(currUsed == a.used());
 }
+
+void testThreadCachingArenaSameThread() {
+  printHeader(__func__);
+  auto a = Arena::ThreadCachingArena<4096>();
+
+  // First allocation carves out this thread's chunk
+  auto* x = new (a.allocate(sizeof(int), alignof(int))) int(7);
+  assert(*x == 7);
+  assert(reinterpret_cast<std::uintptr_t>(x) % alignof(int) == 0);
+  assert(a.local_chunk_count() == 1);
+
+  auto* y = new (a.allocate(sizeof(double))) double(1.5);
+  assert(reinterpret_cast<std::uintptr_t>(y) % Arena::max_alignment == 0);
+  assert(*y == 1.5);
+
+  // Freeing everything on the owning thread resets the chunk
+  a.deallocate(unsafeCastToBytePtr(x), sizeof(int), alignof(int));
+  assert(a.local_used() != 0);
+  a.deallocate(unsafeCastToBytePtr(y), sizeof(double));
+  assert(a.local_used() == 0);
+
+  // And the next allocation re-uses the same memory
+  auto* z = new (a.allocate(sizeof(int), alignof(int))) int(9);
+  assert(unsafeCastToBytePtr(z) == unsafeCastToBytePtr(x));
+  a.deallocate(unsafeCastToBytePtr(z), sizeof(int), alignof(int));
+
+  // Too big for a chunk, expect a Heap Alloc and a global delete
+  constexpr size_t big = decltype(a)::max_chunked_size + 1;
+  std::cout << ">>> Expect to see Heap Alloc:\n";
+  auto* b = unsafeCastToBytePtr(a.allocate(big));
+  a.deallocate(b, big);
+  assert(a.local_chunk_count() == 1);
+}
+
+void testThreadCachingArenaCrossThreadFree() {
+  printHeader(__func__);
+  auto a = Arena::ThreadCachingArena<4096>();
+  constexpr int count = 64;
+
+  std::vector<int*> ptrs;
+  for (int i = 0; i < count; i++) {
+    ptrs.push_back(new (a.allocate(sizeof(int), alignof(int))) int(i));
+  }
+  const auto usedBefore = a.local_used();
+  assert(usedBefore != 0);
+
+  // Another thread frees everything, which only queues onto the return list
+  std::thread([&] {
+    for (auto* p : ptrs) a.deallocate(unsafeCastToBytePtr(p), sizeof(int));
+  }).join();
+  assert(a.local_used() == usedBefore);
+
+  // The owning thread drains the list and gets its chunk back
+  a.drain();
+  assert(a.local_used() == 0);
+  assert(a.local_chunk_count() == 1);
+  auto* p = new (a.allocate(sizeof(int), alignof(int))) int(1);
+  assert(p == ptrs.front());
+  a.deallocate(unsafeCastToBytePtr(p), sizeof(int));
+}
+
+void testThreadCachingArenaManyThreads() {
+  printHeader(__func__);
+  constexpr int threads = 8;
+  constexpr int count = 2000;
+  auto a = Arena::ThreadCachingArena<4096>();
+  std::vector<std::vector<size_t*>> ptrs(threads);
+  std::latch allocated(threads);
+  std::latch freed(threads);
+
+  auto worker = [&](int id) {
+    // Allocate enough to need several chunks per thread
+    for (int i = 0; i < count; i++) {
+      auto* p = new (a.allocate(sizeof(size_t))) size_t(id * count + i);
+      ptrs[id].push_back(p);
+    }
+    allocated.arrive_and_wait();
+
+    // Free the neighbour's blocks, while the neighbour frees ours
+    const int other = (id + 1) % threads;
+    for (int i = 0; i < count; i++) {
+      assert(*ptrs[other][i] == static_cast<size_t>(other * count + i));
+      a.deallocate(unsafeCastToBytePtr(ptrs[other][i]), sizeof(size_t));
+    }
+    freed.arrive_and_wait();
+
+    // Everything we own came back through the return lists
+    a.drain();
+    assert(a.local_used() == 0);
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads; i++) pool.emplace_back(worker, i);
+  for (auto& t : pool) t.join();
+}
+
+void testThreadCachingArenaThreadChurn() {
+  printHeader(__func__);
+  constexpr int rounds = 50;
+  constexpr int count = 1000;
+  auto a = Arena::ThreadCachingArena<4096>();
+  std::vector<size_t*> ptrs;
+
+  // Short lived threads, each filling a few chunks then exiting. Their blocks
+  // are freed afterwards from this thread, which never allocated itself
+  size_t chunksPerThread = 0;
+  for (int round = 0; round < rounds; round++) {
+    std::thread([&] {
+      for (int i = 0; i < count; i++) {
+        ptrs.push_back(new (a.allocate(sizeof(size_t))) size_t(i));
+      }
+      chunksPerThread = std::max(chunksPerThread, a.local_chunk_count());
+    }).join();
+
+    for (auto* p : ptrs) a.deallocate(unsafeCastToBytePtr(p), sizeof(size_t));
+    ptrs.clear();
+  }
+
+  // Every new thread adopted the chunks of the previous one
+  assert(chunksPerThread > 1);
+  assert(a.chunk_count() == chunksPerThread);
+}
+
+void testGrowableArenaChainsBlocks() {
+  printHeader(__func__);
+  auto a = Arena::GrowableArena<64>();
+  assert(a.block_count() == 0 && a.capacity() == 0);
+
+  // Fill the first block with max-aligned chars
+  std::cout << ">>> Expect to see exactly one Heap Alloc:\n";
+  for (size_t i = 0; i < 64 / Arena::max_alignment; i++) {
+    auto* c = new (a.allocate(sizeof(char))) char('a');
+    assert(a.in_buffer(unsafeCastToBytePtr(c)));
+  }
+  assert(a.block_count() == 1 && a.capacity() == 64);
+
+  // Next one chains a block twice the size instead of falling back to heap
+  std::cout << ">>> Expect to see exactly one Heap Alloc:\n";
+  auto* c = new (a.allocate(sizeof(char))) char('b');
+  assert(a.in_buffer(unsafeCastToBytePtr(c)));
+  assert(a.block_count() == 2 && a.capacity() == 64 + 128);
+  assert(a.used() == 64 + 1);
+
+  // Stack-like reclaim still works within the current block
+  a.deallocate(unsafeCastToBytePtr(c), sizeof(char));
+  assert(a.used() == 64);
+}
+
+void testGrowableArenaOversizedRequest() {
+  printHeader(__func__);
+  auto a = Arena::GrowableArena<64>();
+
+  // Much bigger than the first block, gets a block of its own
+  constexpr size_t big = 1000;
+  auto* p = unsafeCastToBytePtr(a.allocate(big));
+  assert(a.in_buffer(p) && a.in_buffer(p + big - 1));
+  assert(a.block_count() == 1 && a.capacity() == big);
+
+  // Over-aligned requests are honoured too
+  auto* q = unsafeCastToBytePtr(a.allocate(8, 256));
+  assert(a.in_buffer(q));
+  assert(reinterpret_cast<std::uintptr_t>(q) % 256 == 0);
+}
+
+void testGrowableArenaResetReusesBlocks() {
+  printHeader(__func__);
+  auto a = Arena::GrowableArena<64>();
+
+  // First cycle grows the chain
+  std::vector<std::byte*> firstCycle;
+  for (int i = 0; i < 20; i++) {
+    firstCycle.push_back(unsafeCastToBytePtr(a.allocate(sizeof(double))));
+  }
+  const auto blocks = a.block_count();
+  const auto capacity = a.capacity();
+  assert(blocks > 1);
+
+  // O(1) reset, every block is kept
+  a.reset();
+  assert(a.used() == 0);
+  assert(a.block_count() == blocks && a.capacity() == capacity);
+
+  // Second cycle gets exactly the same memory back, no Heap Alloc
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  for (int i = 0; i < 20; i++) {
+    assert(unsafeCastToBytePtr(a.allocate(sizeof(double))) == firstCycle[i]);
+  }
+  assert(a.block_count() == blocks);
+
+  // Everything goes back to the heap on release
+  a.release();
+  assert(a.block_count() == 0 && a.capacity() == 0 && a.used() == 0);
+}
+
+void testPmrVectorNoGlobalAllocations() {
+  printHeader(__func__);
+  auto arena = Arena::BasicArena<4096>();
+  Arena::ArenaResource resource(arena);
+
+  // Resources are only equal when they share an arena
+  Arena::ArenaResource sameArena(arena);
+  auto otherArena = Arena::BasicArena<16>();
+  Arena::ArenaResource differentArena(otherArena);
+  assert(resource == sameArena);
+  assert(resource != differentArena);
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  const size_t heapAllocsBefore = HEAP_ALLOC_COUNT;
+  {
+    std::pmr::vector<int> v(&resource);
+    for (int i = 0; i < 200; i++) v.push_back(i);
+    for (int i = 0; i < 200; i++) assert(v[i] == i);
+    assert(arena.in_buffer(unsafeCastToBytePtr(v.data())));
+  }
+  assert(HEAP_ALLOC_COUNT == heapAllocsBefore);
+  assert(arena.used() != 0);
+}
+
+void testPmrContainersOnGrowableArena() {
+  printHeader(__func__);
+  auto arena = Arena::GrowableArena<8192>();
+  Arena::ArenaResource resource(arena);
+  // Create the first block up front
+  arena.reset();
+  arena.deallocate(unsafeCastToBytePtr(arena.allocate(1)), 1);
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  const size_t heapAllocsBefore = HEAP_ALLOC_COUNT;
+  {
+    std::pmr::unordered_map<int, std::pmr::string> m(&resource);
+    for (int i = 0; i < 32; i++) {
+      // Long enough to never fit into the small string buffer
+      m.try_emplace(i, 40, static_cast<char>('a' + i % 26));
+    }
+    assert(m.size() == 32);
+    assert(m.at(3) == std::pmr::string(40, 'd', &resource));
+    assert(arena.in_buffer(unsafeCastToBytePtr(m.at(3).data())));
+  }
+  assert(HEAP_ALLOC_COUNT == heapAllocsBefore);
+}
+
+void testArenaAllocatorStlContainers() {
+  printHeader(__func__);
+  using arena_t = Arena::BasicArena<4096>;
+  auto arena = arena_t();
+  Arena::ArenaAllocator<int, arena_t> alloc(arena);
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  const size_t heapAllocsBefore = HEAP_ALLOC_COUNT;
+  {
+    std::vector<int, Arena::ArenaAllocator<int, arena_t>> v(alloc);
+    for (int i = 0; i < 100; i++) v.push_back(i * 2);
+    assert(v[99] == 198);
+    assert(arena.in_buffer(unsafeCastToBytePtr(v.data())));
+
+    // Node based containers rebind the allocator to their node type
+    using string_t = std::basic_string<char, std::char_traits<char>,
+                                       Arena::ArenaAllocator<char, arena_t>>;
+    string_t str("a string well beyond the small string buffer", alloc);
+    assert(arena.in_buffer(unsafeCastToBytePtr(str.data())));
+  }
+  assert(HEAP_ALLOC_COUNT == heapAllocsBefore);
+
+  // Rebound copies compare equal, they share the arena
+  Arena::ArenaAllocator<double, arena_t> rebound(alloc);
+  assert(rebound == alloc);
+  assert(&rebound.arena() == &arena);
+}
+
+void testSizeClassPoolClasses() {
+  printHeader(__func__);
+  using pool_t = Arena::SizeClassPool<256, 4096>;
+
+  // Requests round up to the next power of two, at least a pointer wide
+  static_assert(pool_t::block_size(1, 1) == sizeof(void*));
+  static_assert(pool_t::block_size(24, 8) == 32);
+  static_assert(pool_t::block_size(4, 64) == 64);
+  static_assert(pool_t::block_size(256, 16) == 256);
+  static_assert(pool_t::is_pooled(256, 16) && !pool_t::is_pooled(257, 16));
+
+  // Every block is aligned to its class size
+  auto pool = pool_t();
+  for (size_t s = 1; s <= 256; s *= 2) {
+    auto* p = pool.allocate(s, alignof(char));
+    assert(reinterpret_cast<std::uintptr_t>(p) % pool_t::block_size(s, 1) ==
+           0);
+    pool.deallocate(unsafeCastToBytePtr(p), s, alignof(char));
+  }
+
+  // Same class, distinct and adjacent blocks
+  auto* a = unsafeCastToBytePtr(pool.allocate(sizeof(double)));
+  auto* b = unsafeCastToBytePtr(pool.allocate(sizeof(double)));
+  assert(b - a == static_cast<std::ptrdiff_t>(Arena::max_alignment));
+  pool.deallocate(a, sizeof(double));
+  pool.deallocate(b, sizeof(double));
+}
+
+void testSizeClassPoolOutOfOrderFree() {
+  printHeader(__func__);
+  auto pool = Arena::SizeClassPool<256, 4096>();
+  constexpr int count = 100;
+
+  std::vector<int*> ptrs;
+  for (int i = 0; i < count; i++) {
+    ptrs.push_back(new (pool.allocate(sizeof(int), alignof(int))) int(i));
+  }
+  const auto slabs = pool.slab_count();
+
+  // Free every other block, in the middle of the slab
+  for (int i = 0; i < count; i += 2) {
+    assert(*ptrs[i] == i);
+    pool.deallocate(unsafeCastToBytePtr(ptrs[i]), sizeof(int), alignof(int));
+  }
+  const auto freeBefore = pool.free_count(sizeof(int), alignof(int));
+
+  // Re-allocation takes the freed holes back (most recently freed first)
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  for (int i = count - 2; i >= 0; i -= 2) {
+    auto* p = pool.allocate(sizeof(int), alignof(int));
+    assert(p == ptrs[i]);
+  }
+  assert(pool.free_count(sizeof(int), alignof(int)) ==
+         freeBefore - count / 2);
+  assert(pool.slab_count() == slabs);
+  for (int i = 1; i < count; i += 2) assert(*ptrs[i] == i);
+}
+
+void testSizeClassPoolOversized() {
+  printHeader(__func__);
+  auto pool = Arena::SizeClassPool<256, 4096>();
+
+  std::cout << ">>> Expect to see Heap Alloc:\n";
+  auto* p = unsafeCastToBytePtr(pool.allocate(1000));
+  assert(pool.slab_count() == 0);
+  pool.deallocate(p, 1000);
+}
+
+void testBasicArenaMarkerRollback() {
+  printHeader(__func__);
+  auto a = Arena::BasicArena<1024>();
+  auto* keep = new (a.allocate(sizeof(int), alignof(int))) int(1);
+  const auto marker = a.mark();
+  const auto usedAtMarker = a.used();
+
+  // Out of order frees would not reclaim any of these
+  for (int i = 0; i < 10; i++) a.allocate(sizeof(double), alignof(double));
+  assert(a.used() > usedAtMarker);
+
+  a.rollback(marker);
+  assert(a.used() == usedAtMarker);
+  assert(*keep == 1);
+
+  // Next allocation lands right where the marker was taken
+  auto* next = new (a.allocate(sizeof(int), alignof(int))) int(2);
+  assert(unsafeCastToBytePtr(next) == unsafeCastToBytePtr(keep) + sizeof(int));
+}
+
+void testBasicArenaNestedScopes() {
+  printHeader(__func__);
+  auto a = Arena::BasicArena<1024>();
+  a.allocate(sizeof(char), alignof(char));
+  {
+    Arena::ArenaScope outer(a);
+    a.allocate(64);
+    const auto usedInOuter = a.used();
+    {
+      Arena::ArenaScope inner(a);
+      for (int i = 0; i < 8; i++) a.allocate(16);
+      assert(a.used() > usedInOuter);
+    }
+    // Inner scope only released its own allocations
+    assert(a.used() == usedInOuter);
+  }
+  assert(a.used() == 1);
+}
+
+void testGrowableArenaScopeAcrossBlocks() {
+  printHeader(__func__);
+  auto a = Arena::GrowableArena<64>();
+  a.allocate(sizeof(int));
+  const auto usedBefore = a.used();
+  {
+    Arena::ArenaScope scope(a);
+    // Spill over into several new blocks
+    for (int i = 0; i < 32; i++) a.allocate(sizeof(double));
+    assert(a.block_count() > 1);
+  }
+  // Back in the first block, chained blocks are kept for the next round
+  assert(a.used() == usedBefore);
+  const auto blocks = a.block_count();
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  for (int i = 0; i < 32; i++) a.allocate(sizeof(double));
+  assert(a.block_count() == blocks);
+
+  // Scope taken before any block existed rolls back to empty
+  auto b = Arena::GrowableArena<64>();
+  {
+    Arena::ArenaScope scope(b);
+    b.allocate(100);
+  }
+  assert(b.used() == 0);
+}
+
+void testBasicArenaStats() {
+  printHeader(__func__);
+  // Without stats there is nothing to pay for (buffer, bump pointer and size
+  // of the mapping)
+  static_assert(sizeof(Arena::BasicArena<64>) ==
+                2 * sizeof(std::byte*) + sizeof(size_t));
+
+  auto a = Arena::BasicArena<64, Arena::ArenaStats>();
+  auto* c = unsafeCastToBytePtr(a.allocate(sizeof(char), alignof(char)));
+  auto* i = unsafeCastToBytePtr(a.allocate(sizeof(int), alignof(int)));
+  // int after a char wastes 3 bytes of padding
+  assert(a.stats().allocations() == 2);
+  assert(a.stats().bytes_requested() == sizeof(char) + sizeof(int));
+  assert(a.stats().bytes_padding() == alignof(int) - sizeof(char));
+  assert(a.stats().in_use() == a.used());
+
+  // Freeing the top reclaims it, freeing anything else reclaims nothing
+  a.deallocate(i, sizeof(int));
+  a.deallocate(c, sizeof(char));
+  assert(a.stats().deallocations() == 2);
+  assert(a.stats().in_use() == a.used());
+  assert(a.stats().high_water_mark() == 2 * sizeof(int));
+
+  // Too big, falls back to the heap
+  auto* big = unsafeCastToBytePtr(a.allocate(100));
+  assert(a.stats().fallbacks() == 1 && a.stats().fallback_bytes() == 100);
+  a.deallocate(big, 100);
+
+  // Histogram: 1 byte, 4 bytes and 100 bytes
+  const auto& h = a.stats().size_histogram();
+  assert(h[Arena::ArenaStats::bucket_of(1)] == 1);
+  assert(h[Arena::ArenaStats::bucket_of(4)] == 1);
+  assert(h[Arena::ArenaStats::bucket_of(100)] == 1);
+  assert(Arena::ArenaStats::bucket_of(100) == 7);  // (64, 128]
+
+  // Rollback is accounted as a bulk release
+  const auto marker = a.mark();
+  a.allocate(16);
+  a.rollback(marker);
+  assert(a.stats().in_use() == a.used());
+
+  const auto json = a.stats().toJson();
+  std::cout << json << "\n";
+  assert(json.find("\"allocations\":3") != std::string::npos);
+  assert(json.find("\"fallbacks\":1") != std::string::npos);
+  assert(json.find("{\"le\":128,\"count\":1}") != std::string::npos);
+}
+
+void testSizeClassPoolStats() {
+  printHeader(__func__);
+  auto pool = Arena::SizeClassPool<256, 4096, Arena::ArenaStats>();
+  std::vector<std::byte*> ptrs;
+  for (int i = 0; i < 10; i++) {
+    ptrs.push_back(unsafeCastToBytePtr(pool.allocate(24, 8)));
+  }
+  // 24 bytes are served from the 32 byte class
+  assert(pool.stats().allocations() == 10);
+  assert(pool.stats().bytes_padding() == 10 * (32 - 24));
+  assert(pool.stats().high_water_mark() == 10 * 32);
+
+  for (auto* p : ptrs) pool.deallocate(p, 24, 8);
+  assert(pool.stats().in_use() == 0);
+  assert(pool.stats().high_water_mark() == 10 * 32);
+  std::cout << pool.stats().toJson() << "\n";
+}
+
+void testThrowFallback() {
+  printHeader(__func__);
+  auto a = Arena::BasicArena<16, Arena::NoArenaStats, Arena::ThrowFallback>();
+  a.allocate(16);
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  bool threw = false;
+  try {
+    a.allocate(1);
+  } catch (const std::bad_alloc&) {
+    threw = true;
+  }
+  assert(threw);
+  assert(a.used() == 16);
+}
+
+void testNullFallback() {
+  printHeader(__func__);
+  auto a = Arena::BasicArena<16, Arena::ArenaStats, Arena::NullFallback>();
+  assert(a.allocate(8) != nullptr);
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  assert(a.allocate(16) == nullptr);
+  assert(a.stats().fallbacks() == 1);
+
+  // Sizes big enough to wrap the bump pointer fall back too
+  assert(a.allocate(SIZE_MAX - 8) == nullptr);
+  assert(a.allocate(SIZE_MAX, 1) == nullptr);
+  assert(a.stats().fallbacks() == 3);
+  assert(a.available_size() == 8);
+  // Still usable afterwards
+  assert(a.allocate(8, 1) != nullptr);
+  assert(a.available_size() == 0);
+}
+
+// Counts overflows and serves them from a static overflow buffer
+static size_t OVERFLOW_COUNT = 0;
+alignas(Arena::max_alignment) static std::byte OVERFLOW_BUFFER[256];
+
+void* overflowAllocate(size_t s, size_t) {
+  OVERFLOW_COUNT++;
+  return s <= sizeof(OVERFLOW_BUFFER) ? OVERFLOW_BUFFER : nullptr;
+}
+
+void overflowDeallocate(std::byte* ptr, size_t, size_t) {
+  assert(ptr == OVERFLOW_BUFFER);
+  OVERFLOW_COUNT--;
+}
+
+void testCallbackFallback() {
+  printHeader(__func__);
+  using fallback_t =
+      Arena::CallbackFallback<overflowAllocate, overflowDeallocate>;
+  auto a = Arena::BasicArena<8, Arena::NoArenaStats, fallback_t>();
+
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  auto* p = unsafeCastToBytePtr(a.allocate(64));
+  assert(p == OVERFLOW_BUFFER);
+  assert(OVERFLOW_COUNT == 1);
+  a.deallocate(p, 64);
+  assert(OVERFLOW_COUNT == 0);
+}
+
+void testHeapFallbackOverAligned() {
+  printHeader(__func__);
+  auto a = Arena::BasicArena<16>();
+
+  // Over-aligned heap fall-backs keep their alignment
+  std::cout << ">>> Expect to see Heap Alloc with align [256]:\n";
+  auto* p = unsafeCastToBytePtr(a.allocate(64, 256));
+  assert(!a.in_buffer(p));
+  assert(reinterpret_cast<std::uintptr_t>(p) % 256 == 0);
+  a.deallocate(p, 64, 256);
+}
+
+void testMappedArena() {
+  printHeader(__func__);
+  constexpr size_t sz = 1 << 20;
+
+  // Mapped and pre-faulted, the buffer does not come from the heap
+  std::cout << ">>> Expect to see no Heap Alloc:\n";
+  const size_t heapAllocsBefore = HEAP_ALLOC_COUNT;
+  {
+    Arena::BasicArena<sz> a(Arena::PageOptions{.populate = true});
+    assert(a.is_mapped());
+    assert(a.capacity() == sz && a.available_size() == sz);
+
+    // Page aligned, so max aligned as well
+    auto* p = new (a.allocate(sizeof(double))) double(2.5);
+    assert(reinterpret_cast<std::uintptr_t>(p) % Arena::max_alignment == 0);
+    assert(*p == 2.5);
+
+    // The whole buffer is usable
+    a.allocate(sz - a.used(), 1);
+    assert(a.available_size() == 0);
+  }
+  assert(HEAP_ALLOC_COUNT == heapAllocsBefore);
+
+  // Heap backed arenas are not mapped
+  assert(!Arena::BasicArena<64>().is_mapped());
+}
+
+void testMappedArenaHugePages() {
+  printHeader(__func__);
+  constexpr size_t sz = 4 << 20;
+  // Mapping rounds up to whole (huge) pages
+  assert(Arena::mappedSize(1, Arena::PageOptions{.hugePages = true}) ==
+         2 << 20);
+  assert(Arena::mappedSize(sz + 1, Arena::PageOptions{.hugePages = true}) ==
+         6 << 20);
+
+  // Uses MAP_HUGETLB if huge pages are reserved, transparent ones otherwise
+  Arena::BasicArena<sz> a(Arena::PageOptions{.hugePages = true});
+  assert(a.is_mapped());
+  auto* p = unsafeCastToBytePtr(a.allocate(sz / 2));
+  p[0] = std::byte{1};
+  p[sz / 2 - 1] = std::byte{2};
+  assert(a.in_buffer(p) && a.used() == sz / 2);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace MySBOContainers {
+
+using size_t = std::size_t;
+
+// Bounds policies decide what operator[] does with an index. They are
+// plugged in as a template parameter:
+//   static void check(size_t index, size_t size)
+// at() always throws, whatever the policy.
+
+// Throws std::out_of_range, the check stays in release builds
+struct CheckedBounds {
+  static void check(size_t index, size_t size) {
+    if (index >= size) [[unlikely]]
+      outOfBounds(index, size);
+  }
+
+  [[noreturn, gnu::cold, gnu::noinline]] static void outOfBounds(size_t index,
+                                                                 size_t size) {
+    throw std::out_of_range("Accessing index " + std::to_string(index) +
+                            " but size is " + std::to_string(size));
+  }
+};
+
+// assert()s, so it's checked in debug builds and free with NDEBUG, like
+// std::vector
+struct DebugAssertBounds {
+  static void check([[maybe_unused]] size_t index,
+                    [[maybe_unused]] size_t size) noexcept {
+    assert(index < size && "SBOVector index out of bounds");
+  }
+};
+
+// No check at all, for loops that must vectorise even in debug builds
+struct UncheckedBounds {
+  static void check(size_t, size_t) noexcept {}
+};
+
+}  // namespace MySBOContainers
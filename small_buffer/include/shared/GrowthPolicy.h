@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MySBOContainers {
+
+using size_t = std::size_t;
+
+// Growth policies decide the next heap capacity once a container is full.
+// They are plugged in as a template parameter:
+//   static size_t next(size_t capacity, size_t minCapacity, size_t elemSize)
+// and must return at least minCapacity.
+
+// Doubles the capacity, 0 -> 1 -> 2 -> 4 -> ... (the original behaviour)
+struct DoublingGrowth {
+  static size_t next(size_t capacity, size_t minCapacity, size_t) {
+    size_t newCapacity = capacity == 0 ? 1 : capacity * 2;
+    while (newCapacity < minCapacity) newCapacity *= 2;
+    return newCapacity;
+  }
+};
+
+// Grows by 1.5x, wastes less memory and lets freed chunks be reused by the
+// heap for later growth
+struct OneAndHalfGrowth {
+  static size_t next(size_t capacity, size_t minCapacity, size_t) {
+    size_t newCapacity = capacity < 2 ? capacity + 1 : capacity + capacity / 2;
+    while (newCapacity < minCapacity) newCapacity += newCapacity / 2 + 1;
+    return newCapacity;
+  }
+};
+
+// Doubles, then rounds the buffer up to whole pages so the slack at the end
+// of the last page becomes usable capacity. Meant for large buffers.
+template <size_t PageSize = 4096>
+struct PageRoundedGrowth {
+  static_assert((PageSize & (PageSize - 1)) == 0, "PageSize is a power of 2");
+
+  static size_t next(size_t capacity, size_t minCapacity, size_t elemSize) {
+    const size_t doubled =
+        DoublingGrowth::next(capacity, minCapacity, elemSize);
+    const size_t bytes = (doubled * elemSize + PageSize - 1) & ~(PageSize - 1);
+    return bytes / elemSize;
+  }
+};
+
+}  // namespace MySBOContainers
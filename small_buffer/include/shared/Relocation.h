@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace MySBOContainers {
+
+// A type is trivially relocatable if moving an object to a new address and
+// ending the old one's lifetime is the same as copying its bytes over.
+// Trivially copyable types always are. Types with non-trivial moves but no
+// pointers into themselves (owning handles, std::unique_ptr-like types, ...)
+// can opt in by specialising:
+//
+//   template <>
+//   struct MySBOContainers::is_trivially_relocatable<MyHandle>
+//       : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+// Moves [first, last) into the raw storage at dest and ends the lifetime of
+// the source elements. A single memcpy for trivially relocatable types.
+template <typename T>
+void uninitialized_relocate(T* first, T* last, T* dest) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+                (last - first) * sizeof(T));
+  } else {
+    std::uninitialized_move(first, last, dest);
+    std::destroy(first, last);
+  }
+}
+
+// Same as std::memmove for overlapping ranges, only valid for trivially
+// relocatable types. The source elements are dead afterwards.
+template <typename T>
+void relocate_overlapping(T* first, T* last, T* dest) noexcept {
+  static_assert(is_trivially_relocatable_v<T>);
+  std::memmove(static_cast<void*>(dest), static_cast<const void*>(first),
+               (last - first) * sizeof(T));
+}
+
+// Copies [first, last) into the raw storage at dest, a single memcpy for
+// trivially copyable types
+template <typename T>
+void uninitialized_copy_fast(const T* first, const T* last, T* dest) {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+                (last - first) * sizeof(T));
+  } else {
+    std::uninitialized_copy(first, last, dest);
+  }
+}
+
+}  // namespace MySBOContainers
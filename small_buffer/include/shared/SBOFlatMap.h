@@ -0,0 +1,243 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "shared/SBOVector.h"
+#include "shared/SortedSearch.h"
+
+namespace MySBOContainers {
+
+// Sorted map with unique keys, stored as two parallel SBOVectors: the keys
+// alone are contiguous, so a lookup scans or bisects a dense key array
+// (see SortedSearch.h) without pulling the values into cache. Up to
+// StaticCapacity entries live on the stack, then both arrays spill.
+//
+// Iterators dereference to std::pair<const Key&, Value&> and are
+// invalidated by any insert or erase.
+template <typename Key, typename Value, size_t StaticCapacity = 16,
+          typename Compare = std::less<Key>>
+class SBOFlatMap {
+  SBOVector<Key, StaticCapacity> _keys;
+  SBOVector<Value, StaticCapacity> _values;
+  [[no_unique_address]] Compare _comp;
+
+  // Walks both arrays in step
+  template <bool IsConst>
+  class Iterator {
+    using ValueType = std::conditional_t<IsConst, const Value, Value>;
+
+    template <bool>
+    friend class Iterator;
+
+    const Key* _key = nullptr;
+    ValueType* _value = nullptr;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::pair<Key, Value>;
+    using reference = std::pair<const Key&, ValueType&>;
+
+    // Lets it->first / it->second work on the pair of references
+    struct pointer {
+      reference ref;
+      reference* operator->() { return &ref; }
+    };
+
+    Iterator() = default;
+    Iterator(const Key* key, ValueType* value) : _key(key), _value(value) {}
+
+    // iterator -> const_iterator, copies the pointers since end() has no
+    // entry to dereference
+    template <bool WasConst>
+      requires(IsConst && !WasConst)
+    Iterator(const Iterator<WasConst>& other)
+        : _key(other._key), _value(other._value) {}
+
+    const Key& key() const { return *_key; }
+    ValueType& value() const { return *_value; }
+
+    reference operator*() const { return {*_key, *_value}; }
+    pointer operator->() const { return {**this}; }
+
+    Iterator& operator++() {
+      ++_key;
+      ++_value;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const { return _key == other._key; }
+  };
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  SBOFlatMap() = default;
+
+  SBOFlatMap(std::initializer_list<std::pair<Key, Value>> init) {
+    for (const auto& [key, value] : init) try_emplace(key, value);
+  }
+
+  // Inserts a value constructed from args if key isn't there yet, returns
+  // where it is and whether it was inserted
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    const auto [i, found] = search(key);
+    if (found) return {iteratorAt(i), false};
+
+    _keys.insert(_keys.begin() + i, key);
+    try {
+      _values.emplace(_values.begin() + i, std::forward<Args>(args)...);
+    } catch (...) {
+      _keys.erase(_keys.begin() + i);
+      throw;
+    }
+    return {iteratorAt(i), true};
+  }
+
+  std::pair<iterator, bool> insert(const std::pair<Key, Value>& entry) {
+    return try_emplace(entry.first, entry.second);
+  }
+
+  // Inserts or overwrites the value of key
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+    auto result = try_emplace(key, std::forward<V>(value));
+    if (!result.second) result.first.value() = std::forward<V>(value);
+    return result;
+  }
+
+  // Value of key, default-constructed and inserted if missing
+  Value& operator[](const Key& key) { return try_emplace(key).first.value(); }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  Value& at(const K& key) {
+    auto it = find(key);
+    if (it == end()) throw std::out_of_range("SBOFlatMap::at");
+    return it.value();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  const Value& at(const K& key) const {
+    auto it = find(key);
+    if (it == end()) throw std::out_of_range("SBOFlatMap::at");
+    return it.value();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  iterator find(const K& key) {
+    const auto [i, found] = search(key);
+    return found ? iteratorAt(i) : end();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  const_iterator find(const K& key) const {
+    const auto [i, found] = search(key);
+    return found ? iteratorAt(i) : end();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  bool contains(const K& key) const {
+    return search(key).found;
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  size_t count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  // Removes key, returns how many entries were removed (0 or 1)
+  size_t erase(const Key& key) {
+    const auto [i, found] = search(key);
+    if (!found) return 0;
+    eraseAt(i);
+    return 1;
+  }
+
+  // Removes the entry at pos, returns an iterator to the one after it
+  iterator erase(const_iterator pos) {
+    const size_t i = &pos.key() - _keys.data();
+    eraseAt(i);
+    return iteratorAt(i);
+  }
+
+  void clear() noexcept {
+    _keys.clear();
+    _values.clear();
+  }
+
+  void reserve(size_t newCapacity) {
+    _keys.reserve(newCapacity);
+    _values.reserve(newCapacity);
+  }
+
+  void shrink_to_fit() {
+    _keys.shrink_to_fit();
+    _values.shrink_to_fit();
+  }
+
+  size_t size() const noexcept { return _keys.size(); }
+  bool empty() const noexcept { return _keys.empty(); }
+  bool is_inline() const noexcept { return _keys.is_inline(); }
+
+  // The sorted keys, and the values in the same order
+  std::span<const Key> keys() const noexcept { return {_keys.data(), size()}; }
+  std::span<Value> values() noexcept { return {_values.data(), size()}; }
+  std::span<const Value> values() const noexcept {
+    return {_values.data(), size()};
+  }
+
+  iterator begin() noexcept { return iteratorAt(0); }
+  const_iterator begin() const noexcept { return iteratorAt(0); }
+  iterator end() noexcept { return iteratorAt(size()); }
+  const_iterator end() const noexcept { return iteratorAt(size()); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  friend bool operator==(const SBOFlatMap& lhs, const SBOFlatMap& rhs) {
+    return lhs._keys == rhs._keys && lhs._values == rhs._values;
+  }
+
+ private:
+  template <typename K>
+  KeyPosition search(const K& key) const {
+    return findKey(_keys.data(), _keys.size(), key, _comp);
+  }
+
+  iterator iteratorAt(size_t i) noexcept {
+    return {_keys.data() + i, _values.data() + i};
+  }
+
+  const_iterator iteratorAt(size_t i) const noexcept {
+    return {_keys.data() + i, _values.data() + i};
+  }
+
+  void eraseAt(size_t i) {
+    _keys.erase(_keys.begin() + i);
+    _values.erase(_values.begin() + i);
+  }
+};
+
+}  // namespace MySBOContainers
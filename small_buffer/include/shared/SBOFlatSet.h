@@ -0,0 +1,99 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "shared/SBOVector.h"
+#include "shared/SortedSearch.h"
+
+namespace MySBOContainers {
+
+// Sorted set of unique keys kept contiguous in an SBOVector, so up to
+// StaticCapacity keys live on the stack. Lookups are a linear SIMD-friendly
+// scan or a binary search (see SortedSearch.h), inserts and erases shift the
+// keys after the position.
+//
+// Iterators are plain pointers, invalidated by any insert or erase.
+template <typename Key, size_t StaticCapacity = 16,
+          typename Compare = std::less<Key>>
+class SBOFlatSet {
+  SBOVector<Key, StaticCapacity> _keys;
+  [[no_unique_address]] Compare _comp;
+
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = const Key*;
+  using const_iterator = const Key*;
+
+  SBOFlatSet() = default;
+
+  SBOFlatSet(std::initializer_list<Key> init) {
+    for (const auto& key : init) insert(key);
+  }
+
+  // Inserts key if it isn't there yet, returns where it is and whether it
+  // was inserted
+  std::pair<iterator, bool> insert(const Key& key) {
+    const auto [i, found] = search(key);
+    if (found) return {begin() + i, false};
+    _keys.insert(_keys.begin() + i, key);
+    return {begin() + i, true};
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  iterator find(const K& key) const {
+    const auto [i, found] = search(key);
+    return found ? begin() + i : end();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  bool contains(const K& key) const {
+    return find(key) != end();
+  }
+
+  template <typename K>
+    requires LookupKey<K, Key, Compare>
+  size_t count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  // Removes key, returns how many keys were removed (0 or 1)
+  size_t erase(const Key& key) {
+    auto it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  // Removes the key at pos, returns an iterator to the one after it
+  iterator erase(const_iterator pos) { return _keys.erase(pos); }
+
+  void clear() noexcept { _keys.clear(); }
+  void reserve(size_t newCapacity) { _keys.reserve(newCapacity); }
+  void shrink_to_fit() { _keys.shrink_to_fit(); }
+
+  size_t size() const noexcept { return _keys.size(); }
+  bool empty() const noexcept { return _keys.empty(); }
+  bool is_inline() const noexcept { return _keys.is_inline(); }
+
+  iterator begin() const noexcept { return _keys.data(); }
+  iterator end() const noexcept { return _keys.data() + _keys.size(); }
+
+  friend bool operator==(const SBOFlatSet& lhs, const SBOFlatSet& rhs) {
+    return lhs._keys == rhs._keys;
+  }
+
+ private:
+  template <typename K>
+  KeyPosition search(const K& key) const {
+    return findKey(_keys.data(), _keys.size(), key, _comp);
+  }
+};
+
+}  // namespace MySBOContainers
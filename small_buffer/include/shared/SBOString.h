@@ -0,0 +1,269 @@
+#pragma once
+
+#include <compare>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "shared/SBOVector.h"
+
+namespace MySBOContainers {
+
+// Small string, keeps up to StaticCapacity chars (plus the terminating null)
+// on the stack and spills onto Allocator beyond that, same as SBOVector which
+// it is built on. Interoperates with std::string_view, every read-only
+// operation (find, compare, ...) goes through it.
+//
+// Unlike libstdc++'s std::string, the inline capacity is configurable: the
+// default of 32 fits most keys and identifiers without a heap allocation.
+template <size_t StaticCapacity = 32, typename Allocator = std::allocator<char>>
+class SBOString {
+  // Always holds a null terminator, so size() is one less than _chars.size()
+  SBOVector<char, StaticCapacity + 1, Allocator> _chars;
+
+ public:
+  using value_type = char;
+  using size_type = size_t;
+  using iterator = char*;
+  using const_iterator = const char*;
+  using allocator_type = Allocator;
+
+  static constexpr size_t npos = std::string_view::npos;
+
+  SBOString() : SBOString(Allocator()) {}
+
+  explicit SBOString(const Allocator& alloc) : _chars(alloc) {
+    _chars.push_back('\0');
+  }
+
+  SBOString(std::string_view sv, const Allocator& alloc = Allocator())
+      : SBOString(alloc) {
+    append(sv);
+  }
+
+  SBOString(const char* str, const Allocator& alloc = Allocator())
+      : SBOString(std::string_view(str), alloc) {}
+
+  SBOString(size_t count, char ch, const Allocator& alloc = Allocator())
+      : SBOString(alloc) {
+    append(count, ch);
+  }
+
+  // Copies and moves come from SBOVector, a moved-from string is left empty
+  SBOString(const SBOString&) = default;
+  SBOString& operator=(const SBOString&) = default;
+
+  SBOString(SBOString&& other) noexcept : _chars(std::move(other._chars)) {
+    other._chars.push_back('\0');
+  }
+
+  // Can throw only if the allocator can't be moved over and differs
+  SBOString& operator=(SBOString&& other) noexcept(
+      std::is_nothrow_move_assignable_v<
+          SBOVector<char, StaticCapacity + 1, Allocator>>) {
+    if (this == &other) return *this;
+    _chars = std::move(other._chars);
+    other._chars.push_back('\0');
+    return *this;
+  }
+
+  SBOString& operator=(std::string_view sv) {
+    clear();
+    return append(sv);
+  }
+
+  /* Access */
+
+  const char* c_str() const noexcept { return _chars.data(); }
+  const char* data() const noexcept { return _chars.data(); }
+  char* data() noexcept { return _chars.data(); }
+
+  std::string_view view() const noexcept { return {data(), size()}; }
+  operator std::string_view() const noexcept { return view(); }
+
+  // Index size() is the null terminator
+  char& operator[](size_t i) noexcept { return data()[i]; }
+  const char& operator[](size_t i) const noexcept { return data()[i]; }
+
+  char& at(size_t i) {
+    if (i >= size()) throw std::out_of_range("SBOString::at");
+    return data()[i];
+  }
+
+  const char& at(size_t i) const {
+    if (i >= size()) throw std::out_of_range("SBOString::at");
+    return data()[i];
+  }
+
+  char& front() noexcept { return data()[0]; }
+  char& back() noexcept { return data()[size() - 1]; }
+
+  iterator begin() noexcept { return data(); }
+  const_iterator begin() const noexcept { return data(); }
+  iterator end() noexcept { return data() + size(); }
+  const_iterator end() const noexcept { return data() + size(); }
+
+  /* Capacity */
+
+  size_t size() const noexcept { return _chars.size() - 1; }
+  size_t length() const noexcept { return size(); }
+  bool empty() const noexcept { return size() == 0; }
+  size_t capacity() const noexcept { return _chars.capacity() - 1; }
+  bool is_inline() const noexcept { return _chars.is_inline(); }
+
+  void reserve(size_t newCapacity) { _chars.reserve(newCapacity + 1); }
+  void shrink_to_fit() { _chars.shrink_to_fit(); }
+
+  Allocator get_allocator() const noexcept { return _chars.get_allocator(); }
+
+  /* Modifiers */
+
+  void clear() noexcept {
+    _chars.clear();
+    _chars.push_back('\0');
+  }
+
+  void resize(size_t count, char ch = '\0') {
+    const size_t len = size();
+    _chars.resize(count + 1, ch);
+    _chars[count] = '\0';
+    if (count > len) std::memset(data() + len, ch, count - len);
+  }
+
+  void push_back(char ch) {
+    _chars.back() = ch;
+    _chars.push_back('\0');
+  }
+
+  void pop_back() noexcept {
+    _chars.pop_back();
+    _chars.back() = '\0';
+  }
+
+  SBOString& append(std::string_view sv) {
+    if (sv.empty()) return *this;
+
+    // sv may point into ourselves, growing would leave it dangling
+    if (sv.data() >= data() && sv.data() < data() + _chars.size()) {
+      const SBOString copy(sv);
+      return append(copy.view());
+    }
+
+    const size_t len = size();
+    _chars.resize(len + sv.size() + 1);
+    std::memcpy(data() + len, sv.data(), sv.size());
+    return *this;
+  }
+
+  SBOString& append(size_t count, char ch) {
+    resize(size() + count, ch);
+    return *this;
+  }
+
+  SBOString& operator+=(std::string_view sv) { return append(sv); }
+
+  SBOString& operator+=(char ch) {
+    push_back(ch);
+    return *this;
+  }
+
+  // Removes count chars from pos onwards
+  SBOString& erase(size_t pos = 0, size_t count = npos) {
+    if (pos > size()) throw std::out_of_range("SBOString::erase");
+    count = std::min(count, size() - pos);
+    _chars.erase(_chars.begin() + pos, _chars.begin() + pos + count);
+    return *this;
+  }
+
+  /* Operations, all in terms of std::string_view */
+
+  size_t find(std::string_view sv, size_t pos = 0) const noexcept {
+    return view().find(sv, pos);
+  }
+
+  size_t find(char ch, size_t pos = 0) const noexcept {
+    return view().find(ch, pos);
+  }
+
+  size_t rfind(std::string_view sv, size_t pos = npos) const noexcept {
+    return view().rfind(sv, pos);
+  }
+
+  size_t rfind(char ch, size_t pos = npos) const noexcept {
+    return view().rfind(ch, pos);
+  }
+
+  bool contains(std::string_view sv) const noexcept {
+    return find(sv) != npos;
+  }
+
+  bool starts_with(std::string_view sv) const noexcept {
+    return view().starts_with(sv);
+  }
+
+  bool ends_with(std::string_view sv) const noexcept {
+    return view().ends_with(sv);
+  }
+
+  int compare(std::string_view sv) const noexcept {
+    return view().compare(sv);
+  }
+
+  SBOString substr(size_t pos = 0, size_t count = npos) const {
+    return SBOString(view().substr(pos, count), get_allocator());
+  }
+
+  friend bool operator==(const SBOString& lhs, const SBOString& rhs) noexcept {
+    return lhs.view() == rhs.view();
+  }
+
+  friend bool operator==(const SBOString& lhs, std::string_view rhs) noexcept {
+    return lhs.view() == rhs;
+  }
+
+  // Exact match for string literals, which would otherwise be ambiguous
+  // between the two overloads above
+  friend bool operator==(const SBOString& lhs, const char* rhs) noexcept {
+    return lhs.view() == rhs;
+  }
+
+  friend std::strong_ordering operator<=>(const SBOString& lhs,
+                                          const SBOString& rhs) noexcept {
+    return lhs.view() <=> rhs.view();
+  }
+
+  friend std::strong_ordering operator<=>(const SBOString& lhs,
+                                          std::string_view rhs) noexcept {
+    return lhs.view() <=> rhs;
+  }
+
+  friend std::strong_ordering operator<=>(const SBOString& lhs,
+                                          const char* rhs) noexcept {
+    return lhs.view() <=> rhs;
+  }
+
+  friend SBOString operator+(const SBOString& lhs, std::string_view rhs) {
+    SBOString result(lhs);
+    result.append(rhs);
+    return result;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const SBOString& str) {
+    return os << str.view();
+  }
+};
+
+}  // namespace MySBOContainers
+
+// Hashes the same as the equivalent std::string_view
+template <size_t StaticCapacity, typename Allocator>
+struct std::hash<MySBOContainers::SBOString<StaticCapacity, Allocator>> {
+  size_t operator()(const MySBOContainers::SBOString<StaticCapacity, Allocator>&
+                        str) const noexcept {
+    return std::hash<std::string_view>()(str.view());
+  }
+};
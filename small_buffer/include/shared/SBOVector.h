@@ -1,43 +1,133 @@
 #pragma once
 
-#include <stdio.h>
-
-#include <array>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "shared/BoundsPolicy.h"
+#include "shared/GrowthPolicy.h"
+#include "shared/Relocation.h"
 
 namespace MySBOContainers {
 
 using size_t = std::size_t;
 
+// Build with SBO_TRACK_SPILLS=1 (cmake -DTRACK_SPILLS=ON) to count how many
+// times a container outgrew its stack buffer and spilled onto its allocator
+#ifndef SBO_TRACK_SPILLS
+#define SBO_TRACK_SPILLS 0
+#endif
+
+// Number of spills, across every container. Only updated when
+// SBO_TRACK_SPILLS is set.
+inline std::atomic<size_t> heapSpills{0};
+
 // Guarantees that if the SIZE (number of elements) of this container
 // is lesser than OR equal to the StaticCapacity, we will store the
 // container elements on the stack instead of the heap.
-template <typename T, size_t StaticCapacity = 16>
+//
+// Both the stack buffer and the heap buffer are raw storage, elements are
+// only constructed when inserted and destroyed when removed, so T doesn't
+// need to be default constructible.
+//
+// Trivially copyable and trivially relocatable T (see Relocation.h) are
+// copied, moved and grown with memcpy instead of element by element.
+//
+// Allocator only supplies the heap buffer, elements are constructed in place.
+// Any std::allocator-conforming allocator works, eg. a
+// std::pmr::polymorphic_allocator or Arena::ArenaAllocator<T, BasicArena<N>>
+// from the allocator module to spill into a per-request arena.
+//
+// Growth picks the next heap capacity (see GrowthPolicy.h), shrink_to_fit()
+// moves the elements back into the stack buffer once they fit again.
+//
+// Bounds decides how operator[] checks its index (see BoundsPolicy.h). The
+// default asserts in debug builds only, so release loops over operator[]
+// compile down to plain pointer arithmetic and can vectorise.
+template <typename T, size_t StaticCapacity = 16,
+          typename Allocator = std::allocator<T>,
+          typename Growth = DoublingGrowth,
+          typename Bounds = DebugAssertBounds>
 class SBOVector {
+  using AllocTraits = std::allocator_traits<Allocator>;
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
  private:
   size_t _size;
   size_t _capacity = StaticCapacity;
-  std::array<T, StaticCapacity> _data;
+  // Raw stack buffer, at least one element wide so StaticCapacity can be zero
+  alignas(T) std::byte _data[sizeof(T) * std::max<size_t>(StaticCapacity, 1)];
   T* _dataPtr = nullptr;
+  [[no_unique_address]] Allocator _alloc;
 
  public:
   // Constructor
-  SBOVector() : _size(0), _dataPtr(&_data[0]) {}
+  SBOVector() : SBOVector(Allocator()) {}
+
+  explicit SBOVector(const Allocator& alloc) noexcept
+      : _size(0), _dataPtr(inlineData()), _alloc(alloc) {}
+
+  // Constructs count value-initialised elements
+  explicit SBOVector(size_t count, const Allocator& alloc = Allocator())
+      : SBOVector(alloc) {
+    resize(count);
+  }
+
+  // Constructs count copies of val
+  SBOVector(size_t count, const T& val, const Allocator& alloc = Allocator())
+      : SBOVector(alloc) {
+    resize(count, val);
+  }
+
+  SBOVector(std::initializer_list<T> init,
+            const Allocator& alloc = Allocator())
+      : SBOVector(alloc) {
+    insert(end(), init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  SBOVector(It first, It last, const Allocator& alloc = Allocator())
+      : SBOVector(alloc) {
+    insert(end(), first, last);
+  }
 
   // Copy Constructor
-  SBOVector(const SBOVector& other) {
+  SBOVector(const SBOVector& other)
+      : SBOVector(
+            AllocTraits::select_on_container_copy_construction(other._alloc)) {
     // Check if the other capacity is on the heap
     if (other.capacity() > StaticCapacity) {
-      _dataPtr = new T[other.capacity()];
-    } else {
-      _dataPtr = &_data[0];
+      adoptHeap(allocateHeap(other.capacity()), other.capacity());
     }
 
-    _capacity = other.capacity();
+    try {
+      uninitialized_copy_fast(other.begin(), other.end(), _dataPtr);
+    } catch (...) {
+      freeHeap();
+      throw;
+    }
     _size = other.size();
-
-    std::copy(other._dataPtr, other._dataPtr + other.size(), _dataPtr);
   }
 
   // Copy Assign
@@ -50,25 +140,42 @@ class SBOVector {
   //    the new capacity will be the copied-from capacity.
   //
   SBOVector& operator=(const SBOVector& other) {
+    // Prevent self-assign, we might free the buffer we copy from
+    if (this == &other) return *this;
+
+    // Our heap buffer must go back to the allocator it came from
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+      if (_alloc != other._alloc) {
+        clear();
+        freeHeap();
+        _dataPtr = inlineData();
+        _capacity = StaticCapacity;
+      }
+      _alloc = other._alloc;
+    }
+
     // Case: Other is within stack space, we already allocated on the heap
     // We need to free and store on stack. We don't preserve capacity in this
     // case
     if (other.size() <= StaticCapacity && _capacity > StaticCapacity) {
-      delete[] (_dataPtr);
+      clear();
+      freeHeap();
+      _dataPtr = inlineData();
       _capacity = StaticCapacity;
     }
 
     // Case: Other is beyond stack space, our capacity is not enough
     // We need to re-allocate
     else if (other.size() > StaticCapacity && _capacity < other.size()) {
-      // If we allocated, we need to free
-      if (_capacity > StaticCapacity) {
-        delete[] (_dataPtr);
-      }
+      // If we allocated, we need to free. Go back to the stack buffer so we
+      // stay valid if the allocation below throws.
+      clear();
+      freeHeap();
+      _dataPtr = inlineData();
+      _capacity = StaticCapacity;
 
       // Just take the capacity of the other vector
-      _dataPtr = new T[other.capacity()];
-      _capacity = other.capacity();
+      adoptHeap(allocateHeap(other.capacity()), other.capacity());
     }
 
     // Case: Other is beyond stack space, our capacity is enough
@@ -77,59 +184,381 @@ class SBOVector {
     // Case: Other is within stack space, we didn't allocate on the heap
     /* Don't free or reallocate, keep our existing capacity */
 
-    _size = other.size();
-    // Copy the data over
-    std::copy(other._dataPtr, other._dataPtr + other.size(), _dataPtr);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      // Nothing to construct or destroy, copy the bytes over
+      uninitialized_copy_fast(other.begin(), other.end(), _dataPtr);
+      _size = other.size();
+      return *this;
+    }
+
+    // Assign over the elements we already hold, construct or destroy the rest
+    const size_t common = std::min(_size, other.size());
+    std::copy(other.begin(), other.begin() + common, _dataPtr);
+    if (other.size() > _size) {
+      std::uninitialized_copy(other.begin() + _size, other.end(), end());
+      _size = other.size();
+    } else {
+      destroyTail(other.size());
+    }
     return *this;
   }
 
   // Move Constructor
+  // Semantics:
+  //  - Heap buffers are stolen, no element is touched
+  //  - Stack elements are moved one by one into our own stack buffer
+  //  - The moved-from vector is left empty, back on its stack buffer
+  //  - The allocator is moved along with the heap buffer
+  SBOVector(SBOVector&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T>)
+      : SBOVector(std::move(other._alloc)) {
+    stealFrom(other);
+  }
 
   // Move Assign
+  // Same semantics as the Move Constructor, our own heap buffer (if any) is
+  // freed first. If the allocator doesn't propagate and differs from ours,
+  // the heap buffer can't be stolen and the elements are moved one by one.
+  SBOVector& operator=(SBOVector&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T> &&
+      (AllocTraits::propagate_on_container_move_assignment::value ||
+       AllocTraits::is_always_equal::value)) {
+    // Prevent self-assign
+    if (this == &other) return *this;
 
-  void push_back(const T& val) {
+    clear();
+    freeHeap();
+    _dataPtr = inlineData();
+    _capacity = StaticCapacity;
+
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      _alloc = std::move(other._alloc);
+    } else if (_alloc != other._alloc) {
+      reserve(other.size());
+      uninitialized_relocate(other.begin(), other.end(), _dataPtr);
+      _size = other._size;
+      other._size = 0;
+      return *this;
+    }
+    stealFrom(other);
+    return *this;
+  }
+
+  SBOVector& operator=(std::initializer_list<T> init) {
+    clear();
+    insert(end(), init.begin(), init.end());
+    return *this;
+  }
+
+  void push_back(const T& val) { emplace_back(val); }
+
+  void push_back(T&& val) { emplace_back(std::move(val)); }
+
+  // Constructs the new element in place (re-allocating if needed) and
+  // returns a reference to it
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
     if (_size + 1 > _capacity) {
-      if (_size == StaticCapacity)
-        std::cout
-            << "!!! Stack Capacity Exceeded, falling back to heap allocation\n";
-
-      std::size_t newCapacity = _capacity == 0 ? 1 : _capacity * 2;
-      // Allocate a new chunk
-      T* temp = reinterpret_cast<T*>(new T[newCapacity]);
-
-      // Copy over
-      if (_capacity > StaticCapacity) {  // Already using heap data
-        std::move(_dataPtr, _dataPtr + _size, temp);
-        delete[] (_dataPtr);
-      } else {
-        std::move(_data.begin(), _data.end(), temp);
-      }
-      _capacity = newCapacity;
-      _dataPtr = temp;
+      emplaceBackRealloc(std::forward<Args>(args)...);
+    } else {
+      std::construct_at(_dataPtr + _size, std::forward<Args>(args)...);
+    }
+    return _dataPtr[_size++];
+  }
+
+  // Removes the last element
+  void pop_back() { destroyTail(_size - 1); }
+
+  // Inserts an element constructed from args before pos, returns an iterator
+  // to it
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    const size_t index = pos - begin();
+    emplace_back(std::forward<Args>(args)...);
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+  }
+
+  iterator insert(const_iterator pos, const T& val) {
+    return emplace(pos, val);
+  }
+
+  iterator insert(const_iterator pos, T&& val) {
+    return emplace(pos, std::move(val));
+  }
+
+  // Inserts count copies of val before pos
+  iterator insert(const_iterator pos, size_t count, const T& val) {
+    const size_t index = pos - begin();
+    if (count == 0) return begin() + index;
+    // Copy first, val may refer into our own buffer
+    T copy(val);
+    if (_size + count > _capacity) grow(_size + count);
+    std::uninitialized_fill_n(end(), count, copy);
+    _size += count;
+    std::rotate(begin() + index, end() - count, end());
+    return begin() + index;
+  }
+
+  // Inserts the elements of [first, last) before pos. New elements are
+  // constructed at the end and rotated into place.
+  template <std::input_iterator It>
+  iterator insert(const_iterator pos, It first, It last) {
+    const size_t index = pos - begin();
+    const size_t oldSize = _size;
+    if constexpr (std::forward_iterator<It>) {
+      const size_t count = std::distance(first, last);
+      if (_size + count > _capacity) grow(_size + count);
+      std::uninitialized_copy(first, last, end());
+      _size += count;
+    } else {
+      // Single pass, one at a time
+      for (; first != last; ++first) emplace_back(*first);
+    }
+    std::rotate(begin() + index, begin() + oldSize, end());
+    return begin() + index;
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<T> init) {
+    return insert(pos, init.begin(), init.end());
+  }
+
+  // Removes the element at pos, returns an iterator to the one after it
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  // Removes the elements of [first, last)
+  iterator erase(const_iterator first, const_iterator last) {
+    auto* from = begin() + (first - cbegin());
+    auto* to = begin() + (last - cbegin());
+    if (from == to) return from;
+
+    if constexpr (is_trivially_relocatable_v<T>) {
+      // Destroy the erased elements and slide the tail down over them
+      std::destroy(from, to);
+      relocate_overlapping(to, end(), from);
+      _size -= to - from;
+    } else {
+      auto* newEnd = std::move(to, end(), from);
+      destroyTail(newEnd - begin());
+    }
+    return from;
+  }
+
+  // Removes every element, capacity (and heap buffer) are kept
+  void clear() noexcept { destroyTail(0); }
+
+  // Makes room for at least newCapacity elements
+  void reserve(size_t newCapacity) {
+    if (newCapacity > _capacity) reallocate(newCapacity);
+  }
+
+  // Gives back unused heap capacity. Goes back to the stack buffer if the
+  // elements fit in it, otherwise shrinks the heap buffer to size().
+  void shrink_to_fit() {
+    if (is_inline() || _size == _capacity) return;
+
+    if (_size > StaticCapacity) {
+      reallocate(_size);
+      return;
+    }
+
+    T* heap = _dataPtr;
+    const size_t heapCapacity = _capacity;
+    uninitialized_relocate(heap, heap + _size, inlineData());
+    _dataPtr = inlineData();
+    _capacity = StaticCapacity;
+    deallocateHeap(heap, heapCapacity);
+  }
+
+  // Grows with value-initialised elements or shrinks to count elements
+  void resize(size_t count) {
+    if (count < _size) {
+      destroyTail(count);
+    } else if (count > _size) {
+      if (count > _capacity) grow(count);
+      std::uninitialized_value_construct(end(), begin() + count);
+      _size = count;
     }
-    _dataPtr[_size++] = val;  // Copy construct T
   }
 
-  T operator[](size_t i) const {
-    if (i >= _size) {
-      std::printf("Accessing Index %ld but size is %ld\n", i, _size);
-      throw std::runtime_error("Index out of bounds!");
+  // Grows with copies of val or shrinks to count elements
+  void resize(size_t count, const T& val) {
+    if (count < _size) {
+      destroyTail(count);
+    } else if (count > _size) {
+      insert(end(), count - _size, val);
     }
+  }
+
+  void swap(SBOVector& other) {
+    SBOVector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+
+  T& operator[](size_t i) noexcept(noexcept(Bounds::check(i, _size))) {
+    Bounds::check(i, _size);
     return _dataPtr[i];
   }
 
+  const T& operator[](size_t i) const
+      noexcept(noexcept(Bounds::check(i, _size))) {
+    Bounds::check(i, _size);
+    return _dataPtr[i];
+  }
+
+  T& at(size_t i) {
+    if (i >= _size) throw std::out_of_range("SBOVector::at");
+    return _dataPtr[i];
+  }
+
+  const T& at(size_t i) const {
+    if (i >= _size) throw std::out_of_range("SBOVector::at");
+    return _dataPtr[i];
+  }
+
+  T& front() { return _dataPtr[0]; }
+  const T& front() const { return _dataPtr[0]; }
+  T& back() { return _dataPtr[_size - 1]; }
+  const T& back() const { return _dataPtr[_size - 1]; }
+
+  T* data() noexcept { return _dataPtr; }
+  const T* data() const noexcept { return _dataPtr; }
+
+  std::span<T> span() noexcept { return {_dataPtr, _size}; }
+  std::span<const T> span() const noexcept { return {_dataPtr, _size}; }
+
+  iterator begin() noexcept { return _dataPtr; }
+  const_iterator begin() const noexcept { return _dataPtr; }
+  const_iterator cbegin() const noexcept { return _dataPtr; }
+  iterator end() noexcept { return _dataPtr + _size; }
+  const_iterator end() const noexcept { return _dataPtr + _size; }
+  const_iterator cend() const noexcept { return _dataPtr + _size; }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
   size_t capacity() const { return _capacity; }
 
   size_t size() const { return _size; }
 
+  bool empty() const noexcept { return _size == 0; }
+
+  // Whether the elements currently live in the stack buffer
+  bool is_inline() const noexcept { return _capacity <= StaticCapacity; }
+
+  Allocator get_allocator() const noexcept { return _alloc; }
+
+  friend bool operator==(const SBOVector& lhs, const SBOVector& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend void swap(SBOVector& lhs, SBOVector& rhs) { lhs.swap(rhs); }
+
   // Destructor
   ~SBOVector() {
-    if (_capacity > StaticCapacity) {
-      delete[] (_dataPtr);
-    }
+    clear();
+    freeHeap();
   }
 
  private:
+  T* inlineData() noexcept { return reinterpret_cast<T*>(_data); }
+
+  T* allocateHeap(size_t n) { return AllocTraits::allocate(_alloc, n); }
+
+  void deallocateHeap(T* ptr, size_t n) noexcept {
+    AllocTraits::deallocate(_alloc, ptr, n);
+  }
+
+  // Frees our heap buffer, if we have one. Elements must be destroyed first.
+  void freeHeap() noexcept {
+    if (_capacity > StaticCapacity) deallocateHeap(_dataPtr, _capacity);
+  }
+
+  // Switches over to a heap buffer holding our (already relocated) elements
+  void adoptHeap(T* buffer, size_t newCapacity) noexcept {
+#if SBO_TRACK_SPILLS
+    if (is_inline()) heapSpills.fetch_add(1, std::memory_order_relaxed);
+#endif
+    freeHeap();
+    _dataPtr = buffer;
+    _capacity = newCapacity;
+  }
+
+  // Destroys the elements from newSize onwards
+  void destroyTail(size_t newSize) noexcept {
+    std::destroy(_dataPtr + newSize, _dataPtr + _size);
+    _size = newSize;
+  }
+
+  // Asks the growth policy for a capacity that fits at least minCapacity
+  size_t nextCapacity(size_t minCapacity) const {
+    return Growth::next(_capacity, minCapacity, sizeof(T));
+  }
+
+  void grow(size_t minCapacity) { reallocate(nextCapacity(minCapacity)); }
+
+  // Slow path of emplace_back. The new element is built straight into the new
+  // chunk before the old elements move over, args may refer into them.
+  template <typename... Args>
+  void emplaceBackRealloc(Args&&... args) {
+    const size_t newCapacity = nextCapacity(_size + 1);
+    T* temp = allocateHeap(newCapacity);
+    try {
+      std::construct_at(temp + _size, std::forward<Args>(args)...);
+    } catch (...) {
+      deallocateHeap(temp, newCapacity);
+      throw;
+    }
+
+    try {
+      uninitialized_relocate(begin(), end(), temp);
+    } catch (...) {
+      std::destroy_at(temp + _size);
+      deallocateHeap(temp, newCapacity);
+      throw;
+    }
+    adoptHeap(temp, newCapacity);
+  }
+
+  // Moves the elements into a fresh heap chunk of newCapacity
+  void reallocate(size_t newCapacity) {
+    // Allocate a new chunk
+    T* temp = allocateHeap(newCapacity);
+
+    // Move over, the old elements are destroyed once they all made it
+    try {
+      uninitialized_relocate(begin(), end(), temp);
+    } catch (...) {
+      deallocateHeap(temp, newCapacity);
+      throw;
+    }
+    adoptHeap(temp, newCapacity);
+  }
+
+  // Takes other's elements, we must be empty and on our stack buffer
+  void stealFrom(SBOVector& other) {
+    if (other._capacity > StaticCapacity) {
+      // Steal the heap buffer
+      _dataPtr = other._dataPtr;
+      _capacity = other._capacity;
+      _size = other._size;
+      other._dataPtr = other.inlineData();
+      other._capacity = StaticCapacity;
+      other._size = 0;
+    } else {
+      // Move element-wise into our stack buffer
+      uninitialized_relocate(other.begin(), other.end(), _dataPtr);
+      _size = other._size;
+      other._size = 0;
+    }
+  }
 };
 
 }  // namespace MySBOContainers
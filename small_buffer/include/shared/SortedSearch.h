@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace MySBOContainers {
+
+using size_t = std::size_t;
+
+// Up to this many keys, arithmetic keys are searched linearly
+constexpr size_t linear_search_limit = 32;
+
+// Index of the first of the sorted keys [keys, keys + n) that is not less
+// than key, ie. std::lower_bound.
+//
+// Small arithmetic key arrays are searched by counting the keys less than
+// key, with no branch in the loop. At -O3 the compiler turns it into packed
+// SIMD compares, which beats the mispredicted branches of a binary search on
+// the handful of keys our small maps hold.
+template <typename Key, typename Compare, typename K>
+size_t lowerBound(const Key* keys, size_t n, const K& key, Compare comp) {
+  constexpr bool defaultOrder = std::is_same_v<Compare, std::less<Key>> ||
+                                std::is_same_v<Compare, std::less<>>;
+  if constexpr (std::is_arithmetic_v<Key> && std::is_same_v<Key, K> &&
+                defaultOrder) {
+    if (n <= linear_search_limit) {
+      size_t index = 0;
+      for (size_t i = 0; i < n; i++) index += keys[i] < key;
+      return index;
+    }
+  }
+  return std::lower_bound(keys, keys + n, key, comp) - keys;
+}
+
+// Sorted keys can always be looked up by a Key, and by anything the
+// comparator accepts if it is transparent (eg. std::less<>)
+template <typename K, typename Key, typename Compare>
+concept LookupKey =
+    std::is_same_v<K, Key> || requires { typename Compare::is_transparent; };
+
+// Where key is in the sorted keys, or where it would be inserted
+struct KeyPosition {
+  size_t index;
+  bool found;
+};
+
+template <typename Key, typename Compare, typename K>
+KeyPosition findKey(const Key* keys, size_t n, const K& key, Compare comp) {
+  const size_t index = lowerBound(keys, n, key, comp);
+  return {index, index < n && !comp(key, keys[index])};
+}
+
+}  // namespace MySBOContainers
@@ -0,0 +1,218 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shared/SBOVector.h"
+
+#if HAVE_BOOST_SMALL_VECTOR
+#include <boost/container/small_vector.hpp>
+#endif
+
+#if HAVE_ABSL_INLINED_VECTOR
+#include "absl/container/inlined_vector.h"
+#endif
+
+// Push, iterate, copy and move cost of SBOVector against std::vector and,
+// when installed, boost::container::small_vector and absl::InlinedVector with
+// the same inline capacity. The argument is the element count, picked to
+// straddle the inline capacities, so the crossover point shows up directly.
+// Every benchmark also reports the heap allocations per iteration.
+//
+// Run with eg. --benchmark_filter=Push --benchmark_counters_tabular=true
+
+/* Count every heap allocation made by the process */
+static size_t HEAP_ALLOC_COUNT = 0;
+
+// Both are out of line: once inlined into a container's allocate() and
+// deallocate(), GCC sees malloc() memory reach operator delete and warns
+// (-Wmismatched-new-delete) on every container in this file
+[[gnu::noinline]] void* operator new(size_t s) {
+  HEAP_ALLOC_COUNT++;
+  if (auto* ptr = std::malloc(s)) return ptr;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+/* Element types */
+
+// Fits libstdc++'s SSO buffer, so only the container allocates
+using ShortString = std::string;
+
+struct Blob64 {
+  std::array<char, 64> bytes;
+};
+
+template <typename T>
+T makeElement(size_t i) {
+  if constexpr (std::is_same_v<T, ShortString>) {
+    return "item-" + std::to_string(i % 1000);
+  } else if constexpr (std::is_same_v<T, Blob64>) {
+    Blob64 blob;
+    blob.bytes.fill(static_cast<char>(i));
+    return blob;
+  } else {
+    return static_cast<T>(i);
+  }
+}
+
+// Something cheap to sum up per element, so iterating can't be optimised out
+size_t weight(int val) { return val; }
+size_t weight(const ShortString& val) { return val.size(); }
+size_t weight(const Blob64& val) { return val.bytes[0]; }
+
+template <typename Container>
+Container makeContainer(size_t count) {
+  using T = typename Container::value_type;
+  Container c;
+  for (size_t i = 0; i < count; i++) c.push_back(makeElement<T>(i));
+  return c;
+}
+
+// Reports the heap allocations made since start, per iteration
+void reportAllocations(benchmark::State& state, size_t start) {
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(HEAP_ALLOC_COUNT - start),
+      benchmark::Counter::kAvgIterations);
+}
+
+/* Benchmarks */
+
+// Builds a container of count elements from scratch and destroys it
+template <typename Container>
+void BM_Push(benchmark::State& state) {
+  using T = typename Container::value_type;
+  const auto count = static_cast<size_t>(state.range(0));
+  const T element = makeElement<T>(1);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    Container c;
+    for (size_t i = 0; i < count; i++) c.push_back(element);
+    benchmark::DoNotOptimize(c.data());
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto c = makeContainer<Container>(count);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (const auto& val : c) sum += weight(val);
+    benchmark::DoNotOptimize(sum);
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Container>
+void BM_Copy(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto c = makeContainer<Container>(count);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    Container copy(c);
+    benchmark::DoNotOptimize(copy.data());
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Move constructs away and move assigns back, ie. two moves per iteration
+template <typename Container>
+void BM_Move(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  auto c = makeContainer<Container>(count);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    Container moved(std::move(c));
+    benchmark::DoNotOptimize(moved.data());
+    c = std::move(moved);
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Sums through operator[], shows what the bounds policy costs a tight loop
+template <typename Container>
+void BM_IndexedSum(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto c = makeContainer<Container>(count);
+
+  for (auto _ : state) {
+    int sum = 0;
+    for (size_t i = 0; i < c.size(); i++) sum += c[i];
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Element counts around the inline capacities (8 and 32)
+void elementCounts(benchmark::internal::Benchmark* b) {
+  b->ArgName("n");
+  for (long n : {4, 8, 16, 32, 64, 256}) b->Arg(n);
+}
+
+}  // namespace
+
+#define CONTAINER_BENCHMARKS(...)                                    \
+  BENCHMARK_TEMPLATE(BM_Push, __VA_ARGS__)->Apply(elementCounts);    \
+  BENCHMARK_TEMPLATE(BM_Iterate, __VA_ARGS__)->Apply(elementCounts); \
+  BENCHMARK_TEMPLATE(BM_Copy, __VA_ARGS__)->Apply(elementCounts);    \
+  BENCHMARK_TEMPLATE(BM_Move, __VA_ARGS__)->Apply(elementCounts);
+
+#if HAVE_BOOST_SMALL_VECTOR
+#define BOOST_BENCHMARKS(T, N) \
+  CONTAINER_BENCHMARKS(boost::container::small_vector<T, N>)
+#else
+#define BOOST_BENCHMARKS(T, N)
+#endif
+
+#if HAVE_ABSL_INLINED_VECTOR
+#define ABSL_BENCHMARKS(T, N) CONTAINER_BENCHMARKS(absl::InlinedVector<T, N>)
+#else
+#define ABSL_BENCHMARKS(T, N)
+#endif
+
+#define INLINE_BENCHMARKS(T, N)                          \
+  CONTAINER_BENCHMARKS(MySBOContainers::SBOVector<T, N>) \
+  BOOST_BENCHMARKS(T, N)                                 \
+  ABSL_BENCHMARKS(T, N)
+
+#define ELEMENT_BENCHMARKS(T)          \
+  CONTAINER_BENCHMARKS(std::vector<T>) \
+  INLINE_BENCHMARKS(T, 8)              \
+  INLINE_BENCHMARKS(T, 32)
+
+ELEMENT_BENCHMARKS(int)
+ELEMENT_BENCHMARKS(ShortString)
+ELEMENT_BENCHMARKS(Blob64)
+
+#define INDEXED_SUM_BENCHMARK(Bounds)                              \
+  BENCHMARK_TEMPLATE(BM_IndexedSum,                                \
+                     MySBOContainers::SBOVector<                   \
+                         int, 32, std::allocator<int>,             \
+                         MySBOContainers::DoublingGrowth, Bounds>) \
+      ->Apply(elementCounts);
+
+INDEXED_SUM_BENCHMARK(MySBOContainers::CheckedBounds)
+INDEXED_SUM_BENCHMARK(MySBOContainers::DebugAssertBounds)
+INDEXED_SUM_BENCHMARK(MySBOContainers::UncheckedBounds)
+
+BENCHMARK_MAIN();
@@ -2,10 +2,20 @@
 
 #include <cassert>
 #include <iostream>
+#include <memory_resource>
+#include <numeric>  // std::accumulate
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 #include <utility>  // std::pair
 #include <vector>
 
 #include "Utils.h"             // Func header macros
+#include "shared/SBOFlatMap.h"  // SBOFlatMap
+#include "shared/SBOFlatSet.h"  // SBOFlatSet
+#include "shared/SBOString.h"   // SBOString
 #include "shared/SBOVector.h"  // SBOVector
 
 /* Debug options note: */
@@ -38,6 +48,77 @@ using SBOVector = MySBOContainers::SBOVector<T>;
 template <typename T, size_t F>
 using SBOVectorWithInitSize = MySBOContainers::SBOVector<T, F>;
 
+// Counts live instances, to check elements are constructed and destroyed
+// exactly when they enter and leave the vector
+struct Tracked {
+  static inline int alive = 0;
+  static inline int constructed = 0;
+  int value;
+
+  // No default constructor on purpose
+  explicit Tracked(int v) : value(v) {
+    alive++;
+    constructed++;
+  }
+  Tracked(const Tracked& other) : value(other.value) {
+    alive++;
+    constructed++;
+  }
+  Tracked(Tracked&& other) noexcept : value(other.value) {
+    alive++;
+    constructed++;
+  }
+  Tracked& operator=(const Tracked&) = default;
+  Tracked& operator=(Tracked&&) noexcept = default;
+  ~Tracked() { alive--; }
+};
+
+// Owning handle with a non-trivial move, but no pointer into itself, so it
+// opts into trivial relocation
+struct Handle {
+  static inline int moves = 0;
+  int* resource;
+
+  explicit Handle(int v) : resource(new int(v)) {}
+  Handle(Handle&& other) noexcept : resource(other.resource) {
+    other.resource = nullptr;
+    moves++;
+  }
+  Handle& operator=(Handle&& other) noexcept {
+    std::swap(resource, other.resource);
+    moves++;
+    return *this;
+  }
+  ~Handle() { delete resource; }
+};
+
+template <>
+struct MySBOContainers::is_trivially_relocatable<Handle> : std::true_type {};
+
+// Hands out heap memory and checks every buffer comes back with its size
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+  static inline int allocations = 0;
+  static inline size_t outstanding = 0;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    allocations++;
+    outstanding += n;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    assert(outstanding >= n);
+    outstanding -= n;
+    std::allocator<T>().deallocate(p, n);
+  }
+  bool operator==(const CountingAllocator&) const { return true; }
+};
+
 /* Function prototypes */
 void testStackAllocationOnly();
 void testStackAllocationOverrideDefaultStaticCapacity();
@@ -45,6 +126,23 @@ void testExceedStackCapacity();
 void testDefaultCapacityZero();
 void testCopyConstructor();
 void testCopyAssign();
+void testMoveConstructor();
+void testMoveAssign();
+void testEmplaceBackAndPopBack();
+void testInsertAndErase();
+void testReserveAndResize();
+void testIteratorsAndReferences();
+void testUninitializedStorage();
+void testTriviallyRelocatable();
+void testAllocatorAware();
+void testGrowthPolicies();
+void testShrinkToFit();
+void testSBOStringStaysInline();
+void testSBOStringOperations();
+void testSortedSearch();
+void testSBOFlatMap();
+void testSBOFlatSet();
+void testBoundsPolicies();
 
 // Main Driver code
 int main() {
@@ -56,6 +154,23 @@ int main() {
   testExceedStackCapacity();
   testCopyConstructor();
   testCopyAssign();
+  testMoveConstructor();
+  testMoveAssign();
+  testEmplaceBackAndPopBack();
+  testInsertAndErase();
+  testReserveAndResize();
+  testIteratorsAndReferences();
+  testUninitializedStorage();
+  testTriviallyRelocatable();
+  testAllocatorAware();
+  testGrowthPolicies();
+  testShrinkToFit();
+  testSBOStringStaysInline();
+  testSBOStringOperations();
+  testSortedSearch();
+  testSBOFlatMap();
+  testSBOFlatSet();
+  testBoundsPolicies();
 
   return 0;
 }
@@ -282,3 +397,669 @@ void testCopyConstructor() {
 
   PRINT_TEST_PASS(__func__);
 }
+
+void testMoveConstructor() {
+  PRINT_FUNC_HEADER(__func__);
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  // Part 1 -- Inline elements are moved one by one
+  constexpr size_t staticSize = 4;
+  auto myVec = SBOVectorWithInitSize<std::string, staticSize>();
+  for (size_t i = 0; i < staticSize; i++) myVec.push_back(std::to_string(i));
+
+  auto moved = SBOVectorWithInitSize<std::string, staticSize>(std::move(myVec));
+  assert(moved.size() == staticSize);
+  assert(moved.is_inline());
+  assert(myVec.empty());
+  for (size_t i = 0; i < staticSize; i++) assert(moved[i] == std::to_string(i));
+
+  // Part 2 -- Heap buffers are stolen, no allocation, same buffer
+  auto heapVec = SBOVectorWithInitSize<int, staticSize>();
+  for (size_t i = 0; i < staticSize * 2; i++) {
+    heapVec.push_back(static_cast<int>(i));
+  }
+  const int* buffer = heapVec.data();
+
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  auto movedHeap = SBOVectorWithInitSize<int, staticSize>(std::move(heapVec));
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == 0);
+#endif
+  assert(movedHeap.data() == buffer);
+  assert(movedHeap.size() == staticSize * 2);
+  assert(heapVec.empty());
+  assert(heapVec.capacity() == staticSize);
+  assert(heapVec.is_inline());
+
+  // The moved-from vector is still usable
+  heapVec.push_back(42);
+  assert(heapVec.size() == 1 && heapVec[0] == 42);
+
+  static_assert(std::is_nothrow_move_constructible_v<SBOVector<int>>);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testMoveAssign() {
+  PRINT_FUNC_HEADER(__func__);
+  constexpr size_t staticSize = 4;
+
+  // Part 1 -- Heap into heap, our buffer is freed and theirs stolen
+  auto src = SBOVectorWithInitSize<int, staticSize>();
+  for (size_t i = 0; i < staticSize * 4; i++) {
+    src.push_back(static_cast<int>(i));
+  }
+  auto dst = SBOVectorWithInitSize<int, staticSize>();
+  for (size_t i = 0; i < staticSize * 2; i++) {
+    dst.push_back(-static_cast<int>(i));
+  }
+  const int* buffer = src.data();
+
+  dst = std::move(src);
+  assert(dst.data() == buffer);
+  assert(dst.size() == staticSize * 4);
+  assert(dst.capacity() == staticSize * 4);
+  assert(src.empty());
+
+  // Part 2 -- Inline into heap, we go back to the stack
+  auto small = SBOVectorWithInitSize<int, staticSize>({7, 8, 9});
+  dst = std::move(small);
+  assert(dst.is_inline());
+  assert(dst == (SBOVectorWithInitSize<int, staticSize>{7, 8, 9}));
+
+  // Part 3 -- Swap inline with heap
+  for (size_t i = 0; i < staticSize * 2; i++) {
+    small.push_back(static_cast<int>(i));
+  }
+  swap(dst, small);
+  assert(dst.size() == staticSize * 2 && !dst.is_inline());
+  assert(small.size() == 3 && small.is_inline());
+  assert(small[2] == 9);
+
+  static_assert(std::is_nothrow_move_assignable_v<SBOVector<int>>);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testEmplaceBackAndPopBack() {
+  PRINT_FUNC_HEADER(__func__);
+  using data_t = std::pair<int, std::string>;
+  auto v = SBOVectorWithInitSize<data_t, 2>();
+
+  auto& first = v.emplace_back(1, "one");
+  assert(first.first == 1 && first.second == "one");
+  v.emplace_back(2, "two");
+
+  // Spill, and push back an element of the vector itself
+  v.push_back(v[0]);
+  assert(v.size() == 3);
+  assert(v.back() == v.front());
+
+  v.pop_back();
+  v.pop_back();
+  assert(v.size() == 1);
+  assert(v.back().second == "one");
+  v.pop_back();
+  assert(v.empty());
+  PRINT_TEST_PASS(__func__);
+}
+
+void testInsertAndErase() {
+  PRINT_FUNC_HEADER(__func__);
+  auto v = SBOVectorWithInitSize<int, 4>{1, 2, 5};
+
+  // Insert in the middle, within inline capacity
+  auto it = v.insert(v.begin() + 2, 3);
+  assert(*it == 3);
+  assert((v == SBOVectorWithInitSize<int, 4>{1, 2, 3, 5}));
+
+  // Insert a range, spills to heap
+  const int more[] = {4, 4, 4};
+  v.insert(v.begin() + 3, std::begin(more), std::end(more));
+  assert((v == SBOVectorWithInitSize<int, 4>{1, 2, 3, 4, 4, 4, 5}));
+  assert(!v.is_inline());
+
+  // Insert count copies at the front, of an element of the vector itself
+  v.insert(v.begin(), 2, v.back());
+  assert((v == SBOVectorWithInitSize<int, 4>{5, 5, 1, 2, 3, 4, 4, 4, 5}));
+
+  // Erase a range and a single element
+  it = v.erase(v.begin() + 5, v.begin() + 7);
+  assert(*it == 4);
+  it = v.erase(v.begin());
+  assert(*it == 5);
+  assert((v == SBOVectorWithInitSize<int, 4>{5, 1, 2, 3, 4, 5}));
+
+  // Erase at the end returns end()
+  assert(v.erase(v.end() - 1) == v.end());
+  v.clear();
+  assert(v.empty());
+  PRINT_TEST_PASS(__func__);
+}
+
+void testReserveAndResize() {
+  PRINT_FUNC_HEADER(__func__);
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  auto v = SBOVectorWithInitSize<int, 4>();
+
+  // Reserving within inline capacity doesn't allocate
+  v.reserve(4);
+  assert(v.capacity() == 4);
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == 0);
+#endif
+
+  // Reserve allocates exactly what was asked for
+  v.reserve(10);
+  assert(v.capacity() == 10);
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == sizeof(int) * 10);
+#endif
+
+  v.resize(6, 3);
+  assert(v.size() == 6 && v[5] == 3);
+  v.resize(2);
+  assert(v.size() == 2 && v.capacity() == 10);
+  v.resize(4);
+  assert(v[3] == 0);
+
+  auto counted = SBOVectorWithInitSize<std::string, 4>(3, "abc");
+  assert(counted.size() == 3 && counted[2] == "abc");
+  PRINT_TEST_PASS(__func__);
+}
+
+void testIteratorsAndReferences() {
+  PRINT_FUNC_HEADER(__func__);
+  auto v = SBOVector<int>(8);
+  std::iota(v.begin(), v.end(), 1);
+  assert(std::accumulate(v.begin(), v.end(), 0) == 36);
+  assert(*v.rbegin() == 8);
+  assert(v.data() == &v[0]);
+
+  // operator[] hands out references
+  v[0] = 100;
+  int& ref = v[1];
+  ref = 200;
+  assert(v.front() == 100 && v[1] == 200);
+
+  // at() throws on out of bounds
+  bool threw = false;
+  try {
+    v.at(v.size());
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // Range constructor, from a std::vector
+  std::vector<int> stdVec{3, 2, 1};
+  auto fromRange = SBOVector<int>(stdVec.begin(), stdVec.end());
+  assert(std::equal(fromRange.begin(), fromRange.end(), stdVec.begin()));
+  PRINT_TEST_PASS(__func__);
+}
+
+void testUninitializedStorage() {
+  PRINT_FUNC_HEADER(__func__);
+  Tracked::alive = Tracked::constructed = 0;
+  {
+    // An empty vector constructs nothing
+    auto v = SBOVectorWithInitSize<Tracked, 4>();
+    assert(Tracked::constructed == 0);
+
+    for (int i = 0; i < 3; i++) v.emplace_back(i);
+    assert(Tracked::alive == 3);
+
+    // Pop and clear destroy
+    v.pop_back();
+    assert(Tracked::alive == 2);
+
+    // Spill to heap, the inline elements are moved out and destroyed
+    for (int i = 0; i < 6; i++) v.emplace_back(i);
+    assert(Tracked::alive == 8);
+    assert(v.size() == 8);
+
+    v.insert(v.begin() + 1, Tracked(-1));
+    v.erase(v.begin() + 2, v.begin() + 4);
+    assert(Tracked::alive == 7);
+    assert(v[1].value == -1);
+
+    auto copy = v;
+    assert(Tracked::alive == 14);
+    copy.resize(2, Tracked(0));
+    assert(Tracked::alive == 9);
+
+    v.clear();
+    assert(Tracked::alive == 2);
+  }
+  assert(Tracked::alive == 0);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testTriviallyRelocatable() {
+  PRINT_FUNC_HEADER(__func__);
+  static_assert(MySBOContainers::is_trivially_relocatable_v<int>);
+  static_assert(MySBOContainers::is_trivially_relocatable_v<Handle>);
+  static_assert(!MySBOContainers::is_trivially_relocatable_v<std::string>);
+
+  // Growth and moves of an opted-in type never call its move constructor
+  Handle::moves = 0;
+  {
+    auto v = SBOVectorWithInitSize<Handle, 2>();
+    for (int i = 0; i < 9; i++) v.emplace_back(i);
+    auto moved = std::move(v);
+    auto inlineVec = SBOVectorWithInitSize<Handle, 2>();
+    inlineVec.emplace_back(42);
+    auto movedInline = std::move(inlineVec);
+    assert(Handle::moves == 0);
+
+    assert(moved.size() == 9);
+    for (int i = 0; i < 9; i++) assert(*moved[i].resource == i);
+    assert(*movedInline[0].resource == 42);
+
+    // Erase slides the tail down without moving element by element
+    moved.erase(moved.begin() + 1, moved.begin() + 3);
+    assert(Handle::moves == 0);
+    assert(moved.size() == 7 && *moved[1].resource == 3);
+  }
+
+  // Trivially copyable types are copied byte-wise, check the values made it
+  auto ints = SBOVectorWithInitSize<int, 4>{1, 2, 3, 4, 5};
+  auto copy = ints;
+  auto smallCopy = SBOVectorWithInitSize<int, 4>{9};
+  smallCopy = ints;
+  assert(copy == ints && smallCopy == ints);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testAllocatorAware() {
+  PRINT_FUNC_HEADER(__func__);
+  // Part 1 -- Every heap buffer goes through the allocator, and back
+  {
+    using Vec = MySBOContainers::SBOVector<int, 4, CountingAllocator<int>>;
+    auto v = Vec();
+    for (int i = 0; i < 4; i++) v.push_back(i);
+    assert(CountingAllocator<int>::allocations == 0);
+
+    for (int i = 4; i < 20; i++) v.push_back(i);
+    auto copy = v;
+    auto moved = std::move(copy);
+    v.reserve(100);
+    assert(CountingAllocator<int>::allocations == 5);
+    assert(moved == Vec(v.begin(), v.end()));
+  }
+  assert(CountingAllocator<int>::outstanding == 0);
+
+  // Part 2 -- Spill into a stack buffer through std::pmr, nothing on the heap
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+#if SBO_TRACK_SPILLS
+  const size_t spillsBefore = MySBOContainers::heapSpills.load();
+#endif
+  std::byte scratch[1024];
+  std::pmr::monotonic_buffer_resource resource(
+      scratch, sizeof(scratch), std::pmr::null_memory_resource());
+  using PmrVec =
+      MySBOContainers::SBOVector<int, 4, std::pmr::polymorphic_allocator<int>>;
+  auto pmrVec = PmrVec(&resource);
+  for (int i = 0; i < 32; i++) pmrVec.push_back(i);
+  assert(pmrVec.get_allocator().resource() == &resource);
+  assert(pmrVec.size() == 32 && pmrVec[31] == 31);
+
+  // Moving between resources that differ moves element-wise
+  std::pmr::monotonic_buffer_resource other(scratch + 512, 512,
+                                            std::pmr::null_memory_resource());
+  auto otherVec = PmrVec(&other);
+  otherVec = std::move(pmrVec);
+  assert(otherVec.get_allocator().resource() == &other);
+  assert(otherVec.size() == 32 && otherVec[31] == 31);
+  assert(pmrVec.empty());
+
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == 0);
+#endif
+#if SBO_TRACK_SPILLS
+  // Each vector left its stack buffer once
+  assert(MySBOContainers::heapSpills.load() - spillsBefore == 2);
+#endif
+  PRINT_TEST_PASS(__func__);
+}
+
+void testGrowthPolicies() {
+  PRINT_FUNC_HEADER(__func__);
+  using MySBOContainers::DoublingGrowth;
+  using MySBOContainers::OneAndHalfGrowth;
+
+  // 1.5x growth
+  auto v = MySBOContainers::SBOVector<int, 4, std::allocator<int>,
+                                      OneAndHalfGrowth>();
+  for (int i = 0; i < 5; i++) v.push_back(i);
+  assert(v.capacity() == 6);
+  for (int i = 5; i < 7; i++) v.push_back(i);
+  assert(v.capacity() == 9);
+
+  // Page rounded growth fills whole pages
+  using Page = MySBOContainers::PageRoundedGrowth<4096>;
+  auto big = MySBOContainers::SBOVector<uint64_t, 4, std::allocator<uint64_t>,
+                                        Page>();
+  for (int i = 0; i < 5; i++) big.push_back(i);
+  assert(big.capacity() == 4096 / sizeof(uint64_t));
+  for (int i = 5; i < 513; i++) big.push_back(i);
+  assert(big.capacity() == 2 * 4096 / sizeof(uint64_t));
+
+  // Policies always satisfy the requested capacity
+  assert(OneAndHalfGrowth::next(0, 1, 1) == 1);
+  assert(OneAndHalfGrowth::next(10, 100, 1) >= 100);
+  assert(DoublingGrowth::next(4, 9, 1) == 16);
+  assert(Page::next(1, 2, 3000) == 2);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testShrinkToFit() {
+  PRINT_FUNC_HEADER(__func__);
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  auto v = SBOVectorWithInitSize<std::string, 4>();
+  for (int i = 0; i < 20; i++) v.push_back(std::to_string(i));
+  assert(v.capacity() == 32);
+
+  // Still too big for the stack buffer, trim the heap buffer
+  v.erase(v.begin() + 10, v.end());
+  v.shrink_to_fit();
+  assert(v.capacity() == 10 && !v.is_inline());
+  assert(v[9] == "9");
+
+  // Small enough, back onto the stack
+  v.resize(3);
+  v.shrink_to_fit();
+  assert(v.is_inline());
+  assert(v.capacity() == 4);
+  assert(v[0] == "0" && v[2] == "2");
+
+  // Nothing to do when already inline
+  v.shrink_to_fit();
+  assert(v.is_inline() && v.size() == 3);
+
+#if OVERLOAD_NEW_DELETE
+  // Growth 8, 16, 32, then the trimmed buffer of 10
+  assert(HEAP_BYTES_ALLOCATED == sizeof(std::string) * (8 + 16 + 32 + 10));
+#endif
+  PRINT_TEST_PASS(__func__);
+}
+
+void testSBOStringStaysInline() {
+  PRINT_FUNC_HEADER(__func__);
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  using namespace std::string_literals;
+  using String = MySBOContainers::SBOString<>;
+
+  // 32 chars fit inline, well past libstdc++'s 15
+  auto key = String("user:1234567890:session:abcdefgh");
+  assert(key.size() == 32);
+  assert(key.is_inline());
+  assert(std::strlen(key.c_str()) == 32);
+
+  auto copy = key;
+  copy.pop_back();
+  copy += '!';
+  assert(copy.ends_with("fg!"));
+
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == 0);
+#endif
+
+  // One more char spills onto the heap
+  key += 'X';
+  assert(!key.is_inline());
+  assert(key.size() == 33 && key.back() == 'X');
+  assert(key.c_str()[33] == '\0');
+
+  // And comes back once it fits again
+  key.pop_back();
+  key.shrink_to_fit();
+  assert(key.is_inline());
+  assert(key == "user:1234567890:session:abcdefgh");
+  PRINT_TEST_PASS(__func__);
+}
+
+void testSBOStringOperations() {
+  PRINT_FUNC_HEADER(__func__);
+  using String = MySBOContainers::SBOString<8>;
+
+  auto s = String("hello");
+  s.append(", ").append("world");
+  assert(s == "hello, world");
+  assert(s.size() == 12 && s.capacity() >= 12);
+
+  // string_view interop
+  std::string_view view = s;
+  assert(view.substr(7) == "world");
+  assert(s.find("world") == 7);
+  assert(s.find('o') == 4 && s.rfind('o') == 8);
+  assert(s.find("xyz") == String::npos);
+  assert(s.contains(", ") && s.starts_with("hell"));
+  assert(s.substr(0, 5) == "hello");
+
+  // Comparisons against strings, views and literals
+  assert(s.compare("hello") > 0);
+  assert(String("abc") < String("abd"));
+  assert(s == std::string("hello, world"));
+  assert(String("abc") != "abcd");
+
+  // Append from ourselves, the buffer may move while we copy
+  s.append(s);
+  assert(s == "hello, worldhello, world");
+  s.append(s.view().substr(0, 5));
+  assert(s.ends_with("worldhello"));
+
+  // Resize, erase, fill constructor
+  s.resize(5);
+  assert(s == "hello" && s.c_str()[5] == '\0');
+  s.resize(7, '!');
+  assert(s == "hello!!");
+  s.erase(1, 3);
+  assert(s == "ho!!");
+  assert(String(3, 'z') == "zzz");
+
+  // Moves leave an empty, usable string behind
+  auto moved = std::move(s);
+  assert(moved == "ho!!" && s.empty() && s.c_str()[0] == '\0');
+  s += "again";
+  assert(s == "again");
+
+  // Hashes the same as the view, usable as a key
+  std::unordered_set<String> keys{"a", "bb", "a"};
+  assert(keys.size() == 2 && keys.count("bb") == 1);
+  assert(std::hash<String>()(moved) ==
+         std::hash<std::string_view>()("ho!!"));
+
+  std::cout << ">>> " << moved + " printed" << std::endl;
+
+  // Move assign is noexcept only if the allocator lets the buffer be stolen,
+  // otherwise the chars are copied over into our own resource
+  using PmrString =
+      MySBOContainers::SBOString<8, std::pmr::polymorphic_allocator<char>>;
+  static_assert(std::is_nothrow_move_assignable_v<String>);
+  static_assert(!std::is_nothrow_move_assignable_v<PmrString>);
+  std::pmr::monotonic_buffer_resource first, second;
+  PmrString spilled("too long to stay inline", &first);
+  PmrString target(&second);
+  target = std::move(spilled);
+  assert(target == "too long to stay inline" && !target.is_inline());
+  assert(target.get_allocator().resource() == &second);
+  PRINT_TEST_PASS(__func__);
+}
+
+void testSortedSearch() {
+  PRINT_FUNC_HEADER(__func__);
+  // The branchless linear scan must agree with std::lower_bound
+  std::mt19937 rng(42);
+  for (size_t n : {0, 1, 7, 16, 32, 33, 100}) {
+    std::vector<int> keys(n);
+    for (auto& k : keys) k = rng() % 64;
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    for (int key = -1; key <= 65; key++) {
+      const size_t expected =
+          std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+      assert(MySBOContainers::lowerBound(keys.data(), keys.size(), key,
+                                         std::less<int>()) == expected);
+    }
+  }
+  PRINT_TEST_PASS(__func__);
+}
+
+void testSBOFlatMap() {
+  PRINT_FUNC_HEADER(__func__);
+#if OVERLOAD_NEW_DELETE
+  HEAP_BYTES_ALLOCATED = 0;
+#endif
+  // Part 1 -- Small map stays on the stack, entries are kept sorted
+  auto map = MySBOContainers::SBOFlatMap<int, double, 8>();
+  for (int k : {5, 1, 4, 2, 3}) map[k] = k * 1.5;
+  assert(map.size() == 5);
+  int expectedKey = 1;
+  for (auto [key, value] : map) {
+    assert(key == expectedKey);
+    assert(value == key * 1.5);
+    expectedKey++;
+  }
+  assert(map.keys().front() == 1 && map.keys().back() == 5);
+
+  // Lookups
+  assert(map.contains(4) && !map.contains(6));
+  assert(map.find(3)->second == 4.5);
+  assert(map.find(42) == map.end());
+  assert(map.at(2) == 3.0);
+
+  // iterator -> const_iterator, end() included
+  decltype(map)::const_iterator last = map.end();
+  assert(last == map.cend());
+  assert(map.begin() != map.cend() && map.cbegin() != map.end());
+  size_t walked = 0;
+  for (decltype(map)::const_iterator it = map.begin(); it != last; ++it) {
+    walked++;
+  }
+  assert(walked == map.size());
+
+  // Insert only inserts once, insert_or_assign overwrites
+  assert(!map.try_emplace(1, 100.0).second);
+  assert(map[1] == 1.5);
+  assert(!map.insert_or_assign(1, 100.0).second);
+  assert(map[1] == 100.0);
+  assert(map.insert({6, 9.0}).second);
+
+  // Erase by key and by iterator
+  assert(map.erase(4) == 1 && map.erase(4) == 0);
+  auto next = map.erase(map.find(2));
+  assert(next.key() == 3);
+  assert(map.size() == 4 && map.is_inline());
+
+#if OVERLOAD_NEW_DELETE
+  assert(HEAP_BYTES_ALLOCATED == 0);
+#endif
+
+  // Part 2 -- Spills once it outgrows the stack buffer
+  for (int k = 10; k < 30; k++) map[k] = k;
+  assert(!map.is_inline());
+  assert(map.size() == 24);
+  assert(std::is_sorted(map.keys().begin(), map.keys().end()));
+  assert(map.at(29) == 29.0);
+
+  bool threw = false;
+  try {
+    map.at(1000);
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // Part 3 -- String keys, looked up by string_view with a transparent less
+  using String = MySBOContainers::SBOString<>;
+  auto headers = MySBOContainers::SBOFlatMap<String, String, 16, std::less<>>{
+      {"content-type", "text/html"}, {"accept", "*/*"}, {"host", "example"}};
+  std::string_view host = "host";
+  assert(headers.at(host) == "example");
+  assert(headers.keys().front() == "accept");
+  assert(!headers.contains(std::string_view("cookie")));
+  PRINT_TEST_PASS(__func__);
+}
+
+void testSBOFlatSet() {
+  PRINT_FUNC_HEADER(__func__);
+  auto set = MySBOContainers::SBOFlatSet<uint32_t, 8>{7, 3, 9, 3, 1};
+  assert(set.size() == 4);
+  assert(std::is_sorted(set.begin(), set.end()));
+  assert(set.contains(9u) && !set.contains(2u));
+  assert(set.count(3u) == 1);
+
+  auto [it, inserted] = set.insert(2);
+  assert(inserted && *it == 2);
+  assert(!set.insert(2).second);
+
+  assert(set.erase(7u) == 1 && set.erase(7u) == 0);
+  assert(*set.erase(set.find(2u)) == 3);
+
+  for (uint32_t i = 100; i < 120; i++) set.insert(i);
+  assert(!set.is_inline());
+  for (uint32_t i = 100; i < 120; i++) set.erase(i);
+  set.shrink_to_fit();
+  assert(set.is_inline());
+  assert((set == MySBOContainers::SBOFlatSet<uint32_t, 8>{1, 3, 9}));
+  PRINT_TEST_PASS(__func__);
+}
+
+template <typename Bounds>
+using BoundedVector = MySBOContainers::SBOVector<
+    int, 4, std::allocator<int>, MySBOContainers::DoublingGrowth, Bounds>;
+
+void testBoundsPolicies() {
+  PRINT_FUNC_HEADER(__func__);
+  using MySBOContainers::CheckedBounds;
+  using MySBOContainers::DebugAssertBounds;
+  using MySBOContainers::UncheckedBounds;
+
+  // Only the checked policy can throw from operator[]
+  static_assert(!noexcept(std::declval<BoundedVector<CheckedBounds>&>()[0]));
+  static_assert(noexcept(std::declval<BoundedVector<DebugAssertBounds>&>()[0]));
+  static_assert(noexcept(std::declval<BoundedVector<UncheckedBounds>&>()[0]));
+
+  auto checked = BoundedVector<CheckedBounds>{1, 2, 3};
+  bool threw = false;
+  try {
+    checked[3];
+  } catch (const std::out_of_range& e) {
+    std::cout << ">>> " << e.what() << std::endl;
+    threw = true;
+  }
+  assert(threw);
+
+  // at() throws whatever the policy
+  auto unchecked = BoundedVector<UncheckedBounds>{1, 2, 3};
+  threw = false;
+  try {
+    unchecked.at(3);
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // Unchecked and span access over the same elements
+  int sum = 0;
+  for (size_t i = 0; i < unchecked.size(); i++) sum += unchecked[i];
+  std::span<const int> view = unchecked.span();
+  assert(sum == 6 && std::accumulate(view.begin(), view.end(), 0) == sum);
+  assert(view.data() == unchecked.data());
+
+  // Writable span
+  for (auto& val : checked.span()) val *= 10;
+  assert(checked[2] == 30);
+  PRINT_TEST_PASS(__func__);
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "shared/SharedPtr.h"
+
+namespace MySmartPtrs {
+
+// Hazard Slots are where readers of an AtomicSharedPtr announce which node
+// they are about to copy from, so writers know when a replaced node can be
+// freed. Each thread claims one slot on its first load and gives it back when
+// it exits.
+//
+// Slots come in blocks chained into a list. When every slot is taken the
+// claiming thread appends a new block, so any number of threads can read at
+// once. Blocks are never freed, the list only grows to the most threads ever
+// alive together.
+class HazardSlots {
+ public:
+  static constexpr size_t SlotsPerBlock = 64;
+
+  // The calling thread's slot
+  static std::atomic<const void*>& mine() noexcept {
+    thread_local Claim claim;
+    return claim.slot->hazard;
+  }
+
+  // Spins until no thread is reading through ptr
+  static void waitUntilUnused(const void* ptr) noexcept {
+    for (Block* block = &_head; block; block = block->next.load()) {
+      for (auto& slot : block->slots) {
+        while (slot.hazard.load(std::memory_order_seq_cst) == ptr) {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+ private:
+  // A slot per cache line, readers write to theirs on every load
+  struct alignas(64) Slot {
+    std::atomic<const void*> hazard{nullptr};
+    std::atomic<bool> owned{false};
+  };
+
+  // next is seq_cst like the hazards, so a writer that misses a new block
+  // is ordered before its readers' protect() and they see the new node
+  struct Block {
+    Slot slots[SlotsPerBlock];
+    std::atomic<Block*> next{nullptr};
+  };
+
+  struct Claim {
+    Slot* slot = nullptr;
+
+    Claim() noexcept {
+      Block* block = &_head;
+      while (true) {
+        for (auto& s : block->slots) {
+          if (!s.owned.load(std::memory_order_relaxed) &&
+              !s.owned.exchange(true, std::memory_order_acquire)) {
+            slot = &s;
+            return;
+          }
+        }
+        block = nextOrAppend(block);
+      }
+    }
+
+    ~Claim() { slot->owned.store(false, std::memory_order_release); }
+  };
+
+  // The block after block, appending one if there is none yet. Out of memory
+  // we start over from the head and wait for a slot to free up instead
+  static Block* nextOrAppend(Block* block) noexcept {
+    Block* next = block->next.load();
+    if (next) return next;
+
+    auto* fresh = new (std::nothrow) Block;
+    if (!fresh) {
+      std::this_thread::yield();
+      return &_head;
+    }
+    if (block->next.compare_exchange_strong(next, fresh)) return fresh;
+    // Another thread appended first, use theirs
+    delete fresh;
+    return next;
+  }
+
+  static Block _head;
+};
+
+inline HazardSlots::Block HazardSlots::_head;
+
+// T is the pointee type of the SharedPtr<T> being published
+template <typename T>
+// Atomic Shared Ptr is a SharedPtr<T> slot that threads can load, store,
+// exchange and compare_exchange concurrently without a mutex, eg. to publish
+// read-mostly snapshots (config, routing tables) that get swapped rarely.
+//
+// Every store allocates a small node holding the new SharedPtr, and the slot
+// is an atomic pointer to the current node. Readers protect the node with
+// their hazard slot (see HazardSlots) before copying the SharedPtr out of it,
+// so loads never lock nor wait. Writers swap the node in and then wait for
+// the readers still copying from the old node, which takes a few ns since a
+// reader only holds it for one ref count increment.
+//
+// All operations are sequentially consistent.
+class AtomicSharedPtr {
+ public:
+  using value_type = SharedPtr<T, AtomicRefCount>;
+
+  AtomicSharedPtr() noexcept = default;
+
+  AtomicSharedPtr(value_type desired) : _node(makeNode(std::move(desired))) {}
+
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+  // No one may still be using us here, the node can go right away
+  ~AtomicSharedPtr() { delete _node.load(std::memory_order_relaxed); }
+
+  static constexpr bool is_always_lock_free = false;
+
+  // Loads are lock-free, stores may wait for in-flight loads
+  bool is_lock_free() const noexcept { return false; }
+
+  value_type load() const noexcept {
+    auto& hazard = HazardSlots::mine();
+    Node* node = protect(hazard);
+    value_type result = node ? node->value : value_type();
+    hazard.store(nullptr, std::memory_order_release);
+    return result;
+  }
+
+  operator value_type() const noexcept { return load(); }
+
+  void store(value_type desired) { exchange(std::move(desired)); }
+
+  AtomicSharedPtr& operator=(value_type desired) {
+    store(std::move(desired));
+    return *this;
+  }
+
+  value_type exchange(value_type desired) {
+    Node* old = _node.exchange(makeNode(std::move(desired)),
+                               std::memory_order_seq_cst);
+    return retire(old);
+  }
+
+  // Replaces the stored pointer with desired if it owns the same object as
+  // expected, otherwise loads it into expected
+  bool compare_exchange_strong(value_type& expected, value_type desired) {
+    auto& hazard = HazardSlots::mine();
+    Node* replacement = nullptr;
+    while (true) {
+      Node* current = protect(hazard);
+      if (!sameOwner(current, expected)) {
+        expected = current ? current->value : value_type();
+        hazard.store(nullptr, std::memory_order_release);
+        delete replacement;
+        return false;
+      }
+
+      // Only allocate once we know we are likely to succeed
+      if (!replacement && !isEmpty(desired)) {
+        try {
+          replacement = new Node{std::move(desired)};
+        } catch (...) {
+          hazard.store(nullptr, std::memory_order_release);
+          throw;
+        }
+      }
+
+      // current is protected, so it can't have been freed and reused (ABA)
+      if (_node.compare_exchange_strong(current, replacement,
+                                        std::memory_order_seq_cst)) {
+        hazard.store(nullptr, std::memory_order_release);
+        retire(current);
+        return true;
+      }
+      // Lost a race with another writer, compare against the new value
+    }
+  }
+
+  // Never fails spuriously either, it is just here for the std interface
+  bool compare_exchange_weak(value_type& expected, value_type desired) {
+    return compare_exchange_strong(expected, std::move(desired));
+  }
+
+ private:
+  struct Node {
+    value_type value;
+  };
+
+  // Empty pointers are stored as a null node, loading them costs nothing
+  static Node* makeNode(value_type&& value) {
+    return isEmpty(value) ? nullptr : new Node{std::move(value)};
+  }
+
+  static bool isEmpty(const value_type& ptr) noexcept {
+    return ptr._resource == nullptr && ptr._control == nullptr;
+  }
+
+  static bool sameOwner(const Node* node, const value_type& ptr) noexcept {
+    if (!node) return isEmpty(ptr);
+    return node->value._resource == ptr._resource &&
+           node->value._control == ptr._control;
+  }
+
+  // Publishes the current node in hazard, and re-reads it to make sure it
+  // wasn't replaced (and maybe freed) before the hazard became visible
+  Node* protect(std::atomic<const void*>& hazard) const noexcept {
+    Node* node = _node.load(std::memory_order_acquire);
+    while (true) {
+      hazard.store(node, std::memory_order_seq_cst);
+      Node* again = _node.load(std::memory_order_seq_cst);
+      if (again == node) return node;
+      node = again;
+    }
+  }
+
+  // Frees a node taken out of _node once no reader uses it, handing back the
+  // pointer it held
+  static value_type retire(Node* node) noexcept {
+    if (!node) return value_type();
+    HazardSlots::waitUntilUnused(node);
+    value_type value = std::move(node->value);
+    delete node;
+    return value;
+  }
+
+  std::atomic<Node*> _node{nullptr};
+};
+
+}  // namespace MySmartPtrs
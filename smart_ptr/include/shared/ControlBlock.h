@@ -0,0 +1,175 @@
+#pragma once
+
+#include <memory>
+#include <typeinfo>
+#include <utility>
+
+#include "shared/RefCountPolicy.h"
+
+namespace MySmartPtrs {
+
+// Bookkeeping shared by every SharedPtr and WeakPtr to one object.
+//
+// The strong count tracks SharedPtrs, the object is destroyed (dispose()) when
+// it drops to zero. The weak count tracks WeakPtrs plus one for all the
+// SharedPtrs together, the block itself is freed (destroy()) when it drops to
+// zero.
+//
+// How the object is destroyed and where the block lives are up to the derived
+// blocks, so SharedPtr<T> doesn't depend on either.
+template <typename RefCount>
+class ControlBlock {
+  typename RefCount::Count _strong{1};
+  typename RefCount::Count _weak{1};
+
+ public:
+  void addStrong() noexcept { RefCount::increment(_strong); }
+
+  // Only succeeds while the object is still alive
+  bool tryAddStrong() noexcept {
+    return RefCount::incrementIfNotZero(_strong);
+  }
+
+  void releaseStrong() noexcept {
+    if (RefCount::decrement(_strong)) {
+      dispose();
+      releaseWeak();
+    }
+  }
+
+  void addWeak() noexcept { RefCount::increment(_weak); }
+
+  void releaseWeak() noexcept {
+    if (RefCount::decrement(_weak)) destroy();
+  }
+
+  unsigned int strongCount() const noexcept { return RefCount::load(_strong); }
+
+  // The deleter if there is one of the given type, nullptr otherwise
+  virtual void* deleter(const std::type_info&) noexcept { return nullptr; }
+
+ protected:
+  ControlBlock() = default;
+  ControlBlock(const ControlBlock&) = delete;
+  ControlBlock& operator=(const ControlBlock&) = delete;
+  ~ControlBlock() = default;
+
+  // Destroys the managed object
+  virtual void dispose() noexcept = 0;
+
+  // Frees the control block
+  virtual void destroy() noexcept = 0;
+};
+
+// Control block for an object allocated on its own with new
+template <typename T, typename RefCount>
+class PointerControlBlock final : public ControlBlock<RefCount> {
+  T* _resource;
+
+ public:
+  explicit PointerControlBlock(T* resource) noexcept : _resource(resource) {}
+
+ private:
+  void dispose() noexcept override { delete _resource; }
+  void destroy() noexcept override { delete this; }
+};
+
+// Control block for an object released with a custom Deleter, called as
+// deleter(resource) once the last SharedPtr is gone. The block itself comes
+// from Allocator (rebound to the block type), so eg. an object living in an
+// arena can have its block in the same arena.
+//
+// The deleter is stored in the block, which keeps SharedPtr<T> the same type
+// whatever the deleter. Stateless deleters and allocators take no room.
+template <typename T, typename RefCount, typename Deleter,
+          typename Allocator = std::allocator<T>>
+class DeleterControlBlock final : public ControlBlock<RefCount> {
+ public:
+  using BlockAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<DeleterControlBlock>;
+
+ private:
+  T* _resource;
+  [[no_unique_address]] Deleter _deleter;
+  [[no_unique_address]] BlockAllocator _alloc;
+
+ public:
+  DeleterControlBlock(T* resource, Deleter deleter, const BlockAllocator& alloc)
+      : _resource(resource), _deleter(std::move(deleter)), _alloc(alloc) {}
+
+  void* deleter(const std::type_info& type) noexcept override {
+    return type == typeid(Deleter) ? std::addressof(_deleter) : nullptr;
+  }
+
+ private:
+  void dispose() noexcept override { _deleter(_resource); }
+
+  void destroy() noexcept override {
+    // Our copy of the allocator dies with us, free through a local one
+    BlockAllocator alloc(std::move(_alloc));
+    std::destroy_at(this);
+    std::allocator_traits<BlockAllocator>::deallocate(alloc, this, 1);
+  }
+};
+
+// Control block with the object stored inline, so the counts and the object
+// come from a single allocation and sit next to each other (see makeShared)
+template <typename T, typename RefCount>
+class InplaceControlBlock final : public ControlBlock<RefCount> {
+  // Lives in a union so it is only destroyed by dispose(), not ~Block()
+  union {
+    T _value;
+  };
+
+ public:
+  template <typename... Args>
+  explicit InplaceControlBlock(Args&&... args) {
+    std::construct_at(&_value, std::forward<Args>(args)...);
+  }
+
+  ~InplaceControlBlock() {}
+
+  T* get() noexcept { return &_value; }
+
+ private:
+  void dispose() noexcept override { std::destroy_at(&_value); }
+  void destroy() noexcept override { delete this; }
+};
+
+// Same as InplaceControlBlock, but the block comes from (and goes back to) a
+// user supplied allocator, eg. one backed by an arena (see allocateShared)
+template <typename T, typename RefCount, typename Allocator>
+class AllocatedControlBlock final : public ControlBlock<RefCount> {
+ public:
+  using BlockAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<AllocatedControlBlock>;
+
+ private:
+  [[no_unique_address]] BlockAllocator _alloc;
+  union {
+    T _value;
+  };
+
+ public:
+  template <typename... Args>
+  explicit AllocatedControlBlock(const BlockAllocator& alloc, Args&&... args)
+      : _alloc(alloc) {
+    std::construct_at(&_value, std::forward<Args>(args)...);
+  }
+
+  ~AllocatedControlBlock() {}
+
+  T* get() noexcept { return &_value; }
+
+ private:
+  void dispose() noexcept override { std::destroy_at(&_value); }
+
+  void destroy() noexcept override {
+    // Our copy of the allocator dies with us, free through a local one
+    BlockAllocator alloc(std::move(_alloc));
+    std::destroy_at(this);
+    std::allocator_traits<BlockAllocator>::deallocate(alloc, this, 1);
+  }
+};
+
+}  // namespace MySmartPtrs
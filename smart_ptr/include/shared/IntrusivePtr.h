@@ -0,0 +1,177 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
+#include "shared/RefCountPolicy.h"
+
+namespace MySmartPtrs {
+
+// Derived is the class being counted, RefCount the counting policy (see
+// RefCountPolicy.h)
+template <typename Derived, typename RefCount = AtomicRefCount>
+// Ref Counted is a CRTP base that stores the reference count inside the object
+// itself, for use with IntrusivePtr. It provides the ADL hooks IntrusivePtr
+// looks for as hidden friends, so they are only visible to Derived.
+//
+// The object is deleted through a Derived*, so Derived needs a virtual
+// destructor if it is itself used as a base.
+class RefCounted {
+  mutable typename RefCount::Count _refCount{0};
+
+  static const RefCounted& counted(const Derived* obj) noexcept {
+    return *static_cast<const RefCounted*>(obj);
+  }
+
+  friend void intrusivePtrAddRef(const Derived* obj) noexcept {
+    RefCount::increment(counted(obj)._refCount);
+  }
+
+  friend void intrusivePtrRelease(const Derived* obj) noexcept {
+    if (RefCount::decrement(counted(obj)._refCount)) delete obj;
+  }
+
+  friend unsigned int intrusivePtrRefCount(const Derived* obj) noexcept {
+    return RefCount::load(counted(obj)._refCount);
+  }
+
+ protected:
+  RefCounted() noexcept = default;
+
+  // A copy of an object is a new object, with no references to it yet
+  RefCounted(const RefCounted&) noexcept {}
+  RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+
+  ~RefCounted() = default;
+};
+
+// Reference counted pointer whose count lives inside the pointee, found
+// through ADL hooks on T*:
+//   void intrusivePtrAddRef(const T*) noexcept
+//   void intrusivePtrRelease(const T*) noexcept  // deletes at 0
+//   unsigned int intrusivePtrRefCount(const T*) noexcept
+// RefCounted<T> provides them, types with their own count can define them
+// next to the type instead.
+//
+// The handle is a single pointer, there is no control block to allocate or
+// chase. The price: no WeakPtr, and the count can't outlive the object.
+template <typename T>
+class IntrusivePtr {
+ private:
+  T* _resource = nullptr;
+
+  template <typename U>
+  friend class IntrusivePtr;
+
+  void tryIncreaseRefCount() noexcept {
+    if (_resource) intrusivePtrAddRef(_resource);
+  }
+
+  void tryDecreaseRefCount() noexcept {
+    if (_resource) intrusivePtrRelease(_resource);
+  }
+
+ public:
+  using element_type = T;
+
+  IntrusivePtr() noexcept = default;
+  IntrusivePtr(std::nullptr_t) noexcept {}
+
+  // Takes a reference to resource. addRef = false adopts a reference the
+  // caller already holds (eg. one handed over with detach())
+  explicit IntrusivePtr(T* resource, bool addRef = true) noexcept
+      : _resource(resource) {
+    if (addRef) tryIncreaseRefCount();
+  }
+
+  IntrusivePtr(const IntrusivePtr& other) noexcept
+      : _resource(other._resource) {
+    tryIncreaseRefCount();
+  }
+
+  // Converting copy, eg. IntrusivePtr<Derived> -> IntrusivePtr<Base>
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  IntrusivePtr(const IntrusivePtr<U>& other) noexcept
+      : _resource(other._resource) {
+    tryIncreaseRefCount();
+  }
+
+  IntrusivePtr(IntrusivePtr&& other) noexcept : _resource(other._resource) {
+    other._resource = nullptr;
+  }
+
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  IntrusivePtr(IntrusivePtr<U>&& other) noexcept
+      : _resource(other._resource) {
+    other._resource = nullptr;
+  }
+
+  IntrusivePtr& operator=(const IntrusivePtr& other) noexcept {
+    // Take our reference first, other may be the last owner of our resource
+    IntrusivePtr(other).swap(*this);
+    return *this;
+  }
+
+  IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+    // Prevent self-assign
+    if (this == &other) return *this;
+
+    IntrusivePtr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~IntrusivePtr() { tryDecreaseRefCount(); }
+
+  void swap(IntrusivePtr& other) noexcept {
+    std::swap(_resource, other._resource);
+  }
+
+  void reset() noexcept { IntrusivePtr().swap(*this); }
+
+  void reset(T* resource) noexcept { IntrusivePtr(resource).swap(*this); }
+
+  // Gives up our reference without releasing it, the caller now owns it
+  T* detach() noexcept { return std::exchange(_resource, nullptr); }
+
+  T* get() const noexcept { return _resource; }
+
+  T& operator*() const noexcept { return *_resource; }
+
+  T* operator->() const noexcept { return _resource; }
+
+  explicit operator bool() const noexcept { return _resource != nullptr; }
+
+  // Number of references to the resource, 0 if we don't have one
+  unsigned int refCount() const noexcept {
+    return _resource ? intrusivePtrRefCount(_resource) : 0;
+  }
+
+  bool hasResource() const noexcept { return _resource != nullptr; }
+
+  inline void printRefCountAndResource() const noexcept {
+    std::printf(">>> [Resource = %p, RefCount = %u]\n",
+                static_cast<const void*>(_resource), refCount());
+  }
+
+  template <typename U>
+  bool operator==(const IntrusivePtr<U>& other) const noexcept {
+    return _resource == other.get();
+  }
+
+  bool operator==(std::nullptr_t) const noexcept {
+    return _resource == nullptr;
+  }
+};
+
+// Allocates a T and takes the first reference to it
+template <typename T, typename... Args>
+IntrusivePtr<T> makeIntrusive(Args&&... args) {
+  return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+}  // namespace MySmartPtrs
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace MySmartPtrs {
+
+// Objects waiting to be deleted, type erased so one list can hold any T
+class RetireList {
+  struct Retired {
+    void* ptr;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template <typename T>
+  static void deleteAs(void* ptr) noexcept {
+    delete static_cast<T*>(ptr);
+  }
+
+  std::vector<Retired> _retired;
+
+ public:
+  RetireList() = default;
+  RetireList(const RetireList&) = delete;
+  RetireList& operator=(const RetireList&) = delete;
+  RetireList(RetireList&&) noexcept = default;
+  RetireList& operator=(RetireList&&) noexcept = default;
+
+  ~RetireList() { reclaim(); }
+
+  // Queues ptr for deletion. If we can't even grow the list, the object is
+  // deleted right away, late is better than leaked
+  template <typename T>
+  void retire(T* ptr) noexcept {
+    try {
+      _retired.push_back({ptr, &deleteAs<T>});
+    } catch (...) {
+      delete ptr;
+    }
+  }
+
+  // Deletes everything queued so far
+  void reclaim() noexcept {
+    for (auto& retired : _retired) retired.destroy(retired.ptr);
+    _retired.clear();
+  }
+
+  size_t size() const noexcept { return _retired.size(); }
+  bool empty() const noexcept { return _retired.empty(); }
+
+  void swap(RetireList& other) noexcept { _retired.swap(other._retired); }
+};
+
+// Reclamation Queue deletes retired objects on a background thread of its
+// own, so dropping the last reference to a big object (eg. a multi-MB tree)
+// doesn't stall a latency critical thread. The releasing thread only pays for
+// a lock and a push_back.
+//
+// The queue must outlive every pointer retiring to it. Whatever is still
+// queued when it is destroyed is deleted by the destructor.
+class ReclamationQueue {
+ public:
+  ReclamationQueue() : _thread([this] { run(); }) {}
+
+  ReclamationQueue(const ReclamationQueue&) = delete;
+  ReclamationQueue& operator=(const ReclamationQueue&) = delete;
+
+  ~ReclamationQueue() {
+    {
+      std::lock_guard lock(_mutex);
+      _stopping = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+  }
+
+  template <typename T>
+  void retire(T* ptr) noexcept {
+    {
+      std::lock_guard lock(_mutex);
+      _pending.retire(ptr);
+      _retiredCount++;
+    }
+    _wake.notify_one();
+  }
+
+  // Blocks until everything retired before the call has been deleted
+  void drain() {
+    std::unique_lock lock(_mutex);
+    const size_t target = _retiredCount;
+    _drained.wait(lock, [&] { return _reclaimedCount >= target; });
+  }
+
+  // Objects deleted so far by the background thread
+  size_t reclaimedCount() const {
+    std::lock_guard lock(_mutex);
+    return _reclaimedCount;
+  }
+
+ private:
+  void run() {
+    std::unique_lock lock(_mutex);
+    while (true) {
+      _wake.wait(lock, [&] { return _stopping || !_pending.empty(); });
+
+      // Take the whole batch, and delete it without holding the lock
+      RetireList batch;
+      batch.swap(_pending);
+      const size_t count = batch.size();
+      lock.unlock();
+      batch.reclaim();
+      lock.lock();
+
+      _reclaimedCount += count;
+      _drained.notify_all();
+      if (_stopping && _pending.empty()) return;
+    }
+  }
+
+  mutable std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _drained;
+  RetireList _pending;
+  size_t _retiredCount = 0;
+  size_t _reclaimedCount = 0;
+  bool _stopping = false;
+  std::thread _thread;  // Last, it starts running in the constructor
+};
+
+/* Deleters, see SharedPtr(T*, Deleter) */
+
+// Hands the object to a ReclamationQueue instead of deleting it inline
+struct DeferredDelete {
+  ReclamationQueue* queue;
+
+  template <typename T>
+  void operator()(T* ptr) const noexcept {
+    queue->retire(ptr);
+  }
+};
+
+// Objects retired on this thread with QuiescentDelete, freed on
+// reclaimQuiescent() or when the thread exits
+inline RetireList& quiescentRetireList() noexcept {
+  thread_local RetireList list;
+  return list;
+}
+
+// Parks the object in the releasing thread's own list, no lock at all. The
+// thread frees the batch with reclaimQuiescent() once it is somewhere latency
+// doesn't matter (eg. between two event loop iterations).
+struct QuiescentDelete {
+  template <typename T>
+  void operator()(T* ptr) const noexcept {
+    quiescentRetireList().retire(ptr);
+  }
+};
+
+// Frees everything this thread retired with QuiescentDelete. Returns how many
+// objects were freed.
+inline size_t reclaimQuiescent() noexcept {
+  auto& list = quiescentRetireList();
+  const size_t count = list.size();
+  list.reclaim();
+  return count;
+}
+
+}  // namespace MySmartPtrs
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+
+namespace MySmartPtrs {
+
+// Reference count policies pick how a count is stored and updated, so the
+// same smart pointer can be built for one thread or for many at compile
+// time:
+//   using Count = ...;
+//   static void increment(Count&) noexcept
+//   static bool decrement(Count&) noexcept        // true if it dropped to 0
+//   static bool incrementIfNotZero(Count&) noexcept
+//   static unsigned int load(const Count&) noexcept
+
+// Plain counter (NOT THREAD SAFE), the cheapest option for objects that
+// never leave their thread
+struct SingleThreadRefCount {
+  using Count = unsigned int;
+
+  static void increment(Count& count) noexcept { count++; }
+
+  static bool decrement(Count& count) noexcept { return --count == 0; }
+
+  static bool incrementIfNotZero(Count& count) noexcept {
+    if (count == 0) return false;
+    count++;
+    return true;
+  }
+
+  static unsigned int load(const Count& count) noexcept { return count; }
+};
+
+// Atomic counter, safe to share between threads.
+//
+// Increments are relaxed: a new reference can only be made from an existing
+// one, which already keeps the object alive. Decrements are acq_rel, so every
+// write made through any reference happens-before the object is destroyed by
+// whichever thread drops the last one.
+struct AtomicRefCount {
+  using Count = std::atomic<unsigned int>;
+
+  static void increment(Count& count) noexcept {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static bool decrement(Count& count) noexcept {
+    return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  // For weak -> strong upgrades, must never resurrect a dead object
+  static bool incrementIfNotZero(Count& count) noexcept {
+    unsigned int current = count.load(std::memory_order_relaxed);
+    while (current != 0) {
+      if (count.compare_exchange_weak(current, current + 1,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static unsigned int load(const Count& count) noexcept {
+    return count.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace MySmartPtrs
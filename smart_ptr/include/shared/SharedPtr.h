@@ -0,0 +1,393 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <concepts>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+#include "shared/ControlBlock.h"
+#include "shared/RefCountPolicy.h"
+
+#ifndef DEBUG_PRINT
+#define DEBUG_PRINT 0
+#endif
+
+namespace MySmartPtrs {
+
+template <typename T, typename RefCount>
+class WeakPtr;
+
+template <typename T>
+class AtomicSharedPtr;
+
+// Reference counted pointer. RefCount picks the counting policy at compile
+// time (see RefCountPolicy.h): SingleThreadRefCount for objects that never
+// leave their thread, AtomicRefCount for objects shared between threads.
+//
+// The counts live in a separate control block (see ControlBlock.h), which
+// also lets WeakPtrs observe the object without keeping it alive.
+template <typename T, typename RefCount = AtomicRefCount>
+class SharedPtr {
+ private:
+  T* _resource = nullptr;
+  ControlBlock<RefCount>* _control = nullptr;
+
+  template <typename U, typename R>
+  friend class SharedPtr;
+  template <typename U, typename R>
+  friend class WeakPtr;
+  template <typename U>
+  friend class AtomicSharedPtr;
+  template <typename U, typename R, typename... Args>
+  friend SharedPtr<U, R> makeShared(Args&&... args);
+  template <typename U, typename R, typename Allocator, typename... Args>
+  friend SharedPtr<U, R> allocateShared(const Allocator& alloc,
+                                        Args&&... args);
+
+  // Adopts a reference the caller already took on control
+  SharedPtr(T* resource, ControlBlock<RefCount>* control) noexcept
+      : _resource(resource), _control(control) {}
+
+  // Allocates a DeleterControlBlock for resource from alloc. The deleter is
+  // called right away if we throw, so resource never leaks
+  template <typename Deleter, typename Allocator>
+  static ControlBlock<RefCount>* makeDeleterBlock(T* resource, Deleter& deleter,
+                                                  const Allocator& alloc) {
+    using Block = DeleterControlBlock<T, RefCount, Deleter, Allocator>;
+    using Traits = std::allocator_traits<typename Block::BlockAllocator>;
+
+    try {
+      typename Block::BlockAllocator blockAlloc(alloc);
+      Block* block = Traits::allocate(blockAlloc, 1);
+      try {
+        std::construct_at(block, resource, deleter, blockAlloc);
+      } catch (...) {
+        Traits::deallocate(blockAlloc, block, 1);
+        throw;
+      }
+      return block;
+    } catch (...) {
+      deleter(resource);
+      throw;
+    }
+  }
+
+  // Increase ref count if we are owning a resource
+  void tryIncreaseRefCount() noexcept {
+    if (_control) _control->addStrong();
+  }
+
+  // Decrease ref count if we are owning a resource
+  void tryDecreaseRefCount() noexcept {
+    if (_control) _control->releaseStrong();
+  }
+
+ public:
+  using element_type = T;
+  using weak_type = WeakPtr<T, RefCount>;
+
+  SharedPtr() noexcept = default;
+  SharedPtr(std::nullptr_t) noexcept {}
+
+  // Basic constructor, takes ownership of resource (deleted if we throw).
+  // The counts need an allocation of their own, prefer makeShared.
+  //
+  // Implicit for SingleThreadRefCount only, SingleThreadSharedPtr converted
+  // from T* before it became an alias of SharedPtr
+  explicit(!std::same_as<RefCount, SingleThreadRefCount>)
+      SharedPtr(T* resource)
+      : _resource(resource) {
+#if DEBUG_PRINT
+    std::cout << "Constructor\n";
+#endif
+    try {
+      _control = new PointerControlBlock<T, RefCount>(resource);
+    } catch (...) {
+      delete resource;
+      throw;
+    }
+  }
+
+  // Takes ownership of resource, released with deleter(resource) instead of
+  // delete, eg. DeferredDelete to free it off the releasing thread (see
+  // Reclamation.h), or munmap for mmap'd memory. The deleter is called right
+  // away if we throw
+  template <typename Deleter>
+    requires std::invocable<Deleter&, T*>
+  SharedPtr(T* resource, Deleter deleter)
+      : _resource(resource),
+        _control(makeDeleterBlock(resource, deleter, std::allocator<T>())) {}
+
+  // Same, with the control block allocated from alloc, eg. an arena or pool
+  // that resource itself comes from
+  template <typename Deleter, typename Allocator>
+    requires std::invocable<Deleter&, T*>
+  SharedPtr(T* resource, Deleter deleter, const Allocator& alloc)
+      : _resource(resource),
+        _control(makeDeleterBlock(resource, deleter, alloc)) {}
+
+  // Aliasing constructor, shares ownership of owner's object but points to
+  // resource, usually a part of it (a member, a view into a buffer, ...).
+  // owner's object stays alive as long as we do
+  template <typename U>
+  SharedPtr(const SharedPtr<U, RefCount>& owner, T* resource) noexcept
+      : _resource(resource), _control(owner._control) {
+    tryIncreaseRefCount();
+  }
+
+  // Same, taking over owner's reference instead of adding one
+  template <typename U>
+  SharedPtr(SharedPtr<U, RefCount>&& owner, T* resource) noexcept
+      : _resource(resource), _control(owner._control) {
+    owner._resource = nullptr;
+    owner._control = nullptr;
+  }
+
+  // Copy constructor
+  SharedPtr(const SharedPtr& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+#if DEBUG_PRINT
+    std::cout << "Copy Constructor\n";
+#endif
+    tryIncreaseRefCount();
+  }
+
+  // Converting copy, eg. SharedPtr<Derived> -> SharedPtr<Base>
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  SharedPtr(const SharedPtr<U, RefCount>& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+    tryIncreaseRefCount();
+  }
+
+  // Copy assign
+  SharedPtr& operator=(const SharedPtr& other) noexcept {
+#if DEBUG_PRINT
+    std::cout << "Copy Assign\n";
+#endif
+    // Take our reference first, other may be the last owner of our resource
+    SharedPtr(other).swap(*this);
+    return *this;
+  }
+
+  // Move construct
+  SharedPtr(SharedPtr&& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+#if DEBUG_PRINT
+    std::cout << "Move construct\n";
+#endif
+    // Invalidate the other's resources
+    other._resource = nullptr;
+    other._control = nullptr;
+  }
+
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  SharedPtr(SharedPtr<U, RefCount>&& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+    other._resource = nullptr;
+    other._control = nullptr;
+  }
+
+  // Move assign
+  SharedPtr& operator=(SharedPtr&& other) noexcept {
+#if DEBUG_PRINT
+    std::cout << "Move assign\n";
+#endif
+    // Prevent self-assign
+    if (this == &other) return *this;
+
+    SharedPtr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  // Destructor
+  ~SharedPtr() {
+#if DEBUG_PRINT
+    std::cout << this << " called Destructor\n";
+#endif
+    // Clean up my own resources
+    tryDecreaseRefCount();
+  }
+
+  void swap(SharedPtr& other) noexcept {
+    std::swap(_resource, other._resource);
+    std::swap(_control, other._control);
+  }
+
+  // Drops our reference
+  void reset() noexcept { SharedPtr().swap(*this); }
+
+  // Drops our reference and takes ownership of resource instead
+  void reset(T* resource) { SharedPtr(resource).swap(*this); }
+
+  template <typename Deleter>
+  void reset(T* resource, Deleter deleter) {
+    SharedPtr(resource, std::move(deleter)).swap(*this);
+  }
+
+  template <typename Deleter, typename Allocator>
+  void reset(T* resource, Deleter deleter, const Allocator& alloc) {
+    SharedPtr(resource, std::move(deleter), alloc).swap(*this);
+  }
+
+  T* get() const noexcept { return _resource; }
+
+  // The deleter we were built with if it is a Deleter, nullptr otherwise
+  template <typename Deleter>
+  Deleter* getDeleter() const noexcept {
+    if (!_control) return nullptr;
+    return static_cast<Deleter*>(_control->deleter(typeid(Deleter)));
+  }
+
+  T& operator*() const noexcept { return *_resource; }
+
+  T* operator->() const noexcept { return _resource; }
+
+  explicit operator bool() const noexcept { return _resource != nullptr; }
+
+  /*
+    refCount() returns the number of shared_ptrs that have a reference
+    to the resource, 0 if we don't own one (such as after a move operation)
+  */
+  unsigned int refCount() const noexcept {
+    return _control ? _control->strongCount() : 0;
+  }
+
+  bool hasResource() const noexcept {
+    return _control != nullptr && _resource != nullptr;
+  }
+
+  inline void printRefCountAndResource() const noexcept {
+    std::printf(
+        ">>> [Resource = %p, RefCount = %s]\n", static_cast<void*>(_resource),
+        _control == nullptr ? "(nil)" : std::to_string(refCount()).c_str());
+  }
+
+  template <typename U>
+  bool operator==(const SharedPtr<U, RefCount>& other) const noexcept {
+    return _resource == other.get();
+  }
+
+  bool operator==(std::nullptr_t) const noexcept {
+    return _resource == nullptr;
+  }
+};
+
+// Non-owning observer of a SharedPtr's object. It doesn't keep the object
+// alive, lock() hands out a SharedPtr as long as some other SharedPtr still
+// does. Used to break reference cycles (eg. child -> parent links).
+template <typename T, typename RefCount = AtomicRefCount>
+class WeakPtr {
+ private:
+  T* _resource = nullptr;
+  ControlBlock<RefCount>* _control = nullptr;
+
+  template <typename U, typename R>
+  friend class WeakPtr;
+
+  void tryIncreaseWeakCount() noexcept {
+    if (_control) _control->addWeak();
+  }
+
+  void tryDecreaseWeakCount() noexcept {
+    if (_control) _control->releaseWeak();
+  }
+
+ public:
+  WeakPtr() noexcept = default;
+
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  WeakPtr(const SharedPtr<U, RefCount>& shared) noexcept
+      : _resource(shared._resource), _control(shared._control) {
+    tryIncreaseWeakCount();
+  }
+
+  WeakPtr(const WeakPtr& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+    tryIncreaseWeakCount();
+  }
+
+  WeakPtr(WeakPtr&& other) noexcept
+      : _resource(other._resource), _control(other._control) {
+    other._resource = nullptr;
+    other._control = nullptr;
+  }
+
+  WeakPtr& operator=(const WeakPtr& other) noexcept {
+    WeakPtr(other).swap(*this);
+    return *this;
+  }
+
+  WeakPtr& operator=(WeakPtr&& other) noexcept {
+    if (this == &other) return *this;
+    WeakPtr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~WeakPtr() { tryDecreaseWeakCount(); }
+
+  void swap(WeakPtr& other) noexcept {
+    std::swap(_resource, other._resource);
+    std::swap(_control, other._control);
+  }
+
+  void reset() noexcept { WeakPtr().swap(*this); }
+
+  // A SharedPtr to the object, or an empty one if it's already gone
+  SharedPtr<T, RefCount> lock() const noexcept {
+    if (_control && _control->tryAddStrong()) {
+      return SharedPtr<T, RefCount>(_resource, _control);
+    }
+    return SharedPtr<T, RefCount>();
+  }
+
+  // Number of SharedPtrs still owning the object
+  unsigned int refCount() const noexcept {
+    return _control ? _control->strongCount() : 0;
+  }
+
+  bool expired() const noexcept { return refCount() == 0; }
+};
+
+/* Factories */
+
+// Builds the object inside its control block, ie. one allocation instead of
+// two, and the counts share a cache line with the start of the object.
+//
+// The memory is only freed once the last WeakPtr is gone too, so prefer
+// SharedPtr(new T) for big objects that are observed by long lived WeakPtrs.
+template <typename T, typename RefCount = AtomicRefCount, typename... Args>
+SharedPtr<T, RefCount> makeShared(Args&&... args) {
+  auto* block =
+      new InplaceControlBlock<T, RefCount>(std::forward<Args>(args)...);
+  return SharedPtr<T, RefCount>(block->get(), block);
+}
+
+// Same as makeShared, but the block is allocated with alloc (rebound to the
+// block type), eg. an ArenaAllocator to place it in a BasicArena
+template <typename T, typename RefCount = AtomicRefCount, typename Allocator,
+          typename... Args>
+SharedPtr<T, RefCount> allocateShared(const Allocator& alloc,
+                                      Args&&... args) {
+  using Block = AllocatedControlBlock<T, RefCount, Allocator>;
+  using Traits = std::allocator_traits<typename Block::BlockAllocator>;
+
+  typename Block::BlockAllocator blockAlloc(alloc);
+  Block* block = Traits::allocate(blockAlloc, 1);
+  try {
+    std::construct_at(block, blockAlloc, std::forward<Args>(args)...);
+  } catch (...) {
+    Traits::deallocate(blockAlloc, block, 1);
+    throw;
+  }
+  return SharedPtr<T, RefCount>(block->get(), block);
+}
+
+}  // namespace MySmartPtrs
@@ -0,0 +1,242 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "shared/IntrusivePtr.h"
+#include "shared/SharedPtr.h"
+#include "shared/SingleThreadSharedPtr.h"
+
+// Create, copy, move and traversal cost of our pointers against raw pointers,
+// std::unique_ptr and std::shared_ptr. Every benchmark also reports the heap
+// allocations per iteration.
+//
+// Note libstdc++'s std::shared_ptr skips its atomic ops for as long as the
+// process never started a thread, so here it is closer to our single threaded
+// pointer than it would be in a real multi threaded program.
+//
+// Run with eg. --benchmark_filter=Copy --benchmark_counters_tabular=true
+
+/* Count every heap allocation made by the process */
+static size_t HEAP_ALLOC_COUNT = 0;
+
+[[gnu::noinline]] void* operator new(size_t s) {
+  HEAP_ALLOC_COUNT++;
+  if (auto* ptr = std::malloc(s)) return ptr;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+// The sized delete goes through the unsized one, and neither is inlined, or
+// GCC pairs `new Payload` with free() and flags it as a mismatch
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+/* Pointees, a cache line each like a typical graph node */
+
+struct Payload {
+  int value;
+  char padding[60];
+
+  explicit Payload(int v) : value(v) {}
+};
+
+struct IntrusivePayload
+    : Payload,
+      MySmartPtrs::RefCounted<IntrusivePayload,
+                              MySmartPtrs::SingleThreadRefCount> {
+  using Payload::Payload;
+};
+
+/* Pointer kinds, each knows how to make and release a handle */
+
+struct RawPointer {
+  using Ptr = Payload*;
+  static Ptr make(int v) { return new Payload(v); }
+  static void release(Ptr& ptr) { delete ptr; }
+};
+
+struct UniquePtr {
+  using Ptr = std::unique_ptr<Payload>;
+  static Ptr make(int v) { return std::make_unique<Payload>(v); }
+  static void release(Ptr&) {}
+};
+
+struct StdSharedNew {
+  using Ptr = std::shared_ptr<Payload>;
+  static Ptr make(int v) { return Ptr(new Payload(v)); }
+  static void release(Ptr&) {}
+};
+
+struct StdMakeShared {
+  using Ptr = std::shared_ptr<Payload>;
+  static Ptr make(int v) { return std::make_shared<Payload>(v); }
+  static void release(Ptr&) {}
+};
+
+struct SingleThreadSharedNew {
+  using Ptr = MySmartPtrs::SingleThreadSharedPtr<Payload>;
+  static Ptr make(int v) { return Ptr(new Payload(v)); }
+  static void release(Ptr&) {}
+};
+
+struct SingleThreadMakeShared {
+  using Ptr = MySmartPtrs::SingleThreadSharedPtr<Payload>;
+  static Ptr make(int v) {
+    return MySmartPtrs::makeSingleThreadShared<Payload>(v);
+  }
+  static void release(Ptr&) {}
+};
+
+struct AtomicMakeShared {
+  using Ptr = MySmartPtrs::SharedPtr<Payload>;
+  static Ptr make(int v) { return MySmartPtrs::makeShared<Payload>(v); }
+  static void release(Ptr&) {}
+};
+
+struct Intrusive {
+  using Ptr = MySmartPtrs::IntrusivePtr<IntrusivePayload>;
+  static Ptr make(int v) {
+    return MySmartPtrs::makeIntrusive<IntrusivePayload>(v);
+  }
+  static void release(Ptr&) {}
+};
+
+// Reports the heap allocations made since start, per iteration
+void reportAllocations(benchmark::State& state, size_t start) {
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(HEAP_ALLOC_COUNT - start),
+      benchmark::Counter::kAvgIterations);
+}
+
+// count handles to fresh pointees, in a random order so walking them
+// jumps around memory like a real graph does
+template <typename Kind>
+std::vector<typename Kind::Ptr> makeShuffled(size_t count) {
+  std::vector<typename Kind::Ptr> ptrs;
+  ptrs.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    ptrs.push_back(Kind::make(static_cast<int>(i)));
+  }
+  std::shuffle(ptrs.begin(), ptrs.end(), std::mt19937(42));
+  return ptrs;
+}
+
+template <typename Kind>
+void releaseAll(std::vector<typename Kind::Ptr>& ptrs) {
+  for (auto& ptr : ptrs) Kind::release(ptr);
+}
+
+/* Benchmarks */
+
+// Allocates a pointee, hands it to a pointer and destroys both
+template <typename Kind>
+void BM_CreateDestroy(benchmark::State& state) {
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    auto ptr = Kind::make(1);
+    benchmark::DoNotOptimize(ptr);
+    Kind::release(ptr);
+  }
+  reportAllocations(state, start);
+}
+
+// Copies a handle and drops the copy, ie. one increment and one decrement
+template <typename Kind>
+void BM_CopyDestroy(benchmark::State& state) {
+  auto ptr = Kind::make(1);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    typename Kind::Ptr copy(ptr);
+    benchmark::DoNotOptimize(copy);
+  }
+  reportAllocations(state, start);
+  Kind::release(ptr);
+}
+
+// Move constructs away and move assigns back, ie. two moves per iteration
+template <typename Kind>
+void BM_Move(benchmark::State& state) {
+  auto ptr = Kind::make(1);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    typename Kind::Ptr moved(std::move(ptr));
+    benchmark::DoNotOptimize(moved);
+    ptr = std::move(moved);
+  }
+  reportAllocations(state, start);
+  Kind::release(ptr);
+}
+
+// Sums the pointees through a container of handles, misses in the cache as
+// soon as they stop fitting in it
+template <typename Kind>
+void BM_Traverse(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  auto ptrs = makeShuffled<Kind>(count);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    long sum = 0;
+    for (const auto& ptr : ptrs) sum += ptr->value;
+    benchmark::DoNotOptimize(sum);
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+  releaseAll<Kind>(ptrs);
+}
+
+// Copies a container of handles, which touches every ref count. Split control
+// blocks cost a miss on the block, and inline ones on the pointee
+template <typename Kind>
+void BM_CopyAll(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  auto ptrs = makeShuffled<Kind>(count);
+
+  const size_t start = HEAP_ALLOC_COUNT;
+  for (auto _ : state) {
+    auto copy = ptrs;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  reportAllocations(state, start);
+  state.SetItemsProcessed(state.iterations() * count);
+  releaseAll<Kind>(ptrs);
+}
+
+// From L1 sized to well past the last level cache
+void pointeeCounts(benchmark::internal::Benchmark* b) {
+  b->ArgName("n");
+  for (long n : {1 << 8, 1 << 12, 1 << 16, 1 << 20}) b->Arg(n);
+}
+
+}  // namespace
+
+#define OWNING_BENCHMARKS(Kind)               \
+  BENCHMARK_TEMPLATE(BM_CreateDestroy, Kind); \
+  BENCHMARK_TEMPLATE(BM_Move, Kind);          \
+  BENCHMARK_TEMPLATE(BM_Traverse, Kind)->Apply(pointeeCounts);
+
+#define SHARING_BENCHMARKS(Kind)            \
+  OWNING_BENCHMARKS(Kind)                   \
+  BENCHMARK_TEMPLATE(BM_CopyDestroy, Kind); \
+  BENCHMARK_TEMPLATE(BM_CopyAll, Kind)->Apply(pointeeCounts);
+
+// Raw pointers copy like handles, they are the floor for everything else
+SHARING_BENCHMARKS(RawPointer)
+OWNING_BENCHMARKS(UniquePtr)
+SHARING_BENCHMARKS(StdSharedNew)
+SHARING_BENCHMARKS(StdMakeShared)
+SHARING_BENCHMARKS(SingleThreadSharedNew)
+SHARING_BENCHMARKS(SingleThreadMakeShared)
+SHARING_BENCHMARKS(AtomicMakeShared)
+SHARING_BENCHMARKS(Intrusive)
+
+BENCHMARK_MAIN();
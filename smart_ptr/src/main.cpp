@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <new>
 #include <type_traits>
 
 #include "tests.cpp"
@@ -13,19 +14,26 @@
   std::cout << "=== Welcome to the Smart Pointer submodule. Get ready to " \
                "feel smart! ===\n";
 
-#if OVERLOAD_NEW_DELETE
-// Overload global operator new and delete
+// Overload global operator new and delete, counting every allocation for the
+// allocation-count tests
 void* operator new(size_t s) {
+  HEAP_ALLOC_COUNT.fetch_add(1, std::memory_order_relaxed);
   auto ptr = malloc(s);
+#if OVERLOAD_NEW_DELETE
   std::cout << "New: Heap Allocated " << s << " bytes at " << ptr << std::endl;
+#endif
+  if (!ptr) throw std::bad_alloc();
   return ptr;
 }
 
-void operator delete(void* ptr) {
+void operator delete(void* ptr) noexcept {
   free(ptr);
+#if OVERLOAD_NEW_DELETE
   std::cout << "Delete: Free " << ptr << std::endl;
-}
 #endif
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
 
 // Main Driver code
 int main() {
@@ -34,5 +42,13 @@ int main() {
   Tests::runTest1();
   Tests::runTest2();
   Tests::runTest3();
+  Tests::runTest4();
+  Tests::runTest5();
+  Tests::runTest6();
+  Tests::runTest7();
+  Tests::runTest8();
+  Tests::runTest9();
+  Tests::runTest10();
+  Tests::runTest11();
   return 0;
 }
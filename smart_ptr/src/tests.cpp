@@ -1,6 +1,19 @@
+#include <sys/mman.h>
+
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
-
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "shared/AtomicSharedPtr.h"
+#include "shared/IntrusivePtr.h"
+#include "shared/Reclamation.h"
+#include "shared/SharedPtr.h"
 #include "shared/SingleThreadSharedPtr.h"
 
 #define PRINT_EXPECTS 0
@@ -15,10 +28,136 @@
 
 #define PRINT_TEST_HEADER(c) std::cout << "=== Running Test " << c << " ===\n";
 
+// Bumped by the global operator new in main.cpp (from every thread)
+static std::atomic<size_t> HEAP_ALLOC_COUNT = 0;
+
 // Helpers
 template <typename T>
 using SingleThreadSharedPtr = MySmartPtrs::SingleThreadSharedPtr<T>;
 
+template <typename T>
+using SingleThreadWeakPtr = MySmartPtrs::SingleThreadWeakPtr<T>;
+
+template <typename T>
+using ThreadSafeSharedPtr =
+    MySmartPtrs::SharedPtr<T, MySmartPtrs::AtomicRefCount>;
+
+template <typename T>
+using ThreadSafeWeakPtr = MySmartPtrs::WeakPtr<T, MySmartPtrs::AtomicRefCount>;
+
+// Counts live instances, to check objects are destroyed exactly once
+struct Tracked {
+  static inline std::atomic<int> alive = 0;
+  int value;
+
+  explicit Tracked(int v = 0) : value(v) { alive++; }
+  Tracked(const Tracked& other) : value(other.value) { alive++; }
+  virtual ~Tracked() { alive--; }
+};
+
+struct TrackedChild : Tracked {
+  using Tracked::Tracked;
+};
+
+// Bump allocates from a fixed buffer, counting what goes through it
+struct TestArena {
+  alignas(std::max_align_t) std::byte buffer[1024];
+  size_t used = 0;
+  size_t allocations = 0;
+  size_t deallocations = 0;
+
+  bool contains(const void* ptr) const {
+    auto* p = static_cast<const std::byte*>(ptr);
+    return p >= buffer && p < buffer + sizeof(buffer);
+  }
+};
+
+template <typename T>
+struct TestArenaAllocator {
+  using value_type = T;
+  TestArena* arena;
+
+  explicit TestArenaAllocator(TestArena& a) : arena(&a) {}
+
+  template <typename U>
+  TestArenaAllocator(const TestArenaAllocator<U>& other)
+      : arena(other.arena) {}
+
+  T* allocate(size_t n) {
+    size_t start = (arena->used + alignof(T) - 1) & ~(alignof(T) - 1);
+    assert(start + n * sizeof(T) <= sizeof(arena->buffer));
+    arena->used = start + n * sizeof(T);
+    arena->allocations++;
+    return reinterpret_cast<T*>(arena->buffer + start);
+  }
+
+  void deallocate(T*, size_t) { arena->deallocations++; }
+};
+
+struct ThrowsOnConstruct {
+  ThrowsOnConstruct() { throw std::runtime_error("nope"); }
+};
+
+// Graph node that carries its own count
+template <typename RefCount>
+struct IntrusiveNode
+    : Tracked,
+      MySmartPtrs::RefCounted<IntrusiveNode<RefCount>, RefCount> {
+  MySmartPtrs::IntrusivePtr<IntrusiveNode> next;
+
+  using Tracked::Tracked;
+};
+
+// Type with a count of its own, hooked up through ADL instead of RefCounted
+struct LegacyCounted {
+  int refs = 0;
+  static inline int deleted = 0;
+};
+
+void intrusivePtrAddRef(const LegacyCounted* obj) noexcept {
+  const_cast<LegacyCounted*>(obj)->refs++;
+}
+
+void intrusivePtrRelease(const LegacyCounted* obj) noexcept {
+  if (--const_cast<LegacyCounted*>(obj)->refs == 0) {
+    LegacyCounted::deleted++;
+    delete obj;
+  }
+}
+
+unsigned int intrusivePtrRefCount(const LegacyCounted* obj) noexcept {
+  return obj->refs;
+}
+
+// Remembers which thread destroyed it
+struct ThreadTracked : Tracked {
+  static inline std::thread::id destroyedOn;
+
+  using Tracked::Tracked;
+  ~ThreadTracked() { destroyedOn = std::this_thread::get_id(); }
+};
+
+// Read-mostly snapshot, every field holds the same version
+struct Snapshot : Tracked {
+  std::vector<int> fields;
+
+  explicit Snapshot(int version) : Tracked(version), fields(16, version) {}
+
+  bool consistent() const {
+    for (int field : fields) {
+      if (field != value) return false;
+    }
+    return true;
+  }
+};
+
+// Gives a page mapping back, remembering how big it was
+struct Unmap {
+  size_t length;
+
+  void operator()(std::byte* pages) const noexcept { munmap(pages, length); }
+};
+
 template <typename T>
 static void testFuncPassByValue(SingleThreadSharedPtr<T> ptr) {
   PRINT_FUNC_HEADER(__func__);
@@ -103,6 +242,15 @@ void runTest1() {
   PRINT_EXPECT_MSG(
       "\n||| EXPECT: s_ptr2 and s_ptr3 refCount = 2, s_ptr1 is "
       "invalidated. ||| \n\n");
+
+  // Raw pointers still convert implicitly, the thread safe one is explicit
+  SingleThreadSharedPtr<resource_t> s_ptr4 = new resource_t(8.0);
+  assert(*s_ptr4 == 8.0f);
+  testFuncPassByValue<resource_t>(new resource_t(9.0));
+  static_assert(std::is_convertible_v<resource_t*,
+                                      SingleThreadSharedPtr<resource_t>>);
+  static_assert(
+      !std::is_convertible_v<resource_t*, ThreadSafeSharedPtr<resource_t>>);
 }
 
 // Test 2: Edges cases involving invoking copy assign AFTER being
@@ -191,4 +339,508 @@ void runTest3() {
          ptr2.get() == x);
 }
 
+// Test 4: Atomic ref counts, copies made and dropped from many threads
+void runTest4() {
+  PRINT_TEST_HEADER(4);
+  Tracked::alive = 0;
+  {
+    ThreadSafeSharedPtr<Tracked> shared(new Tracked(42));
+    constexpr int threadCount = 8;
+    constexpr int copiesPerThread = 100000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+      threads.emplace_back([&shared] {
+        for (int i = 0; i < copiesPerThread; i++) {
+          ThreadSafeSharedPtr<Tracked> copy(shared);
+          assert(copy->value == 42);
+          ThreadSafeWeakPtr<Tracked> weak(copy);
+          assert(weak.lock().get() == shared.get());
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    assert(shared.refCount() == 1);
+    assert(Tracked::alive == 1);
+
+    // Last reference dropped on another thread destroys it there, once
+    ThreadSafeWeakPtr<Tracked> observer(shared);
+    std::thread([ptr = std::move(shared)]() mutable { ptr.reset(); }).join();
+    assert(Tracked::alive == 0);
+    assert(observer.expired());
+    assert(!observer.lock());
+  }
+  assert(Tracked::alive == 0);
+
+  // The default policy is the thread-safe one
+  static_assert(
+      std::is_same_v<MySmartPtrs::SharedPtr<int>, ThreadSafeSharedPtr<int>>);
+}
+
+// Test 5: Weak pointers, conversions and cycles
+void runTest5() {
+  PRINT_TEST_HEADER(5);
+  Tracked::alive = 0;
+
+  SingleThreadWeakPtr<Tracked> weak;
+  assert(weak.expired() && !weak.lock());
+  {
+    SingleThreadSharedPtr<TrackedChild> child(new TrackedChild(7));
+    SingleThreadSharedPtr<Tracked> base = child;
+    assert(base.refCount() == 2);
+    assert(base.get() == child.get());
+
+    weak = base;
+    assert(weak.refCount() == 2 && !weak.expired());
+
+    // Weak pointers don't own
+    auto locked = weak.lock();
+    assert(locked->value == 7);
+    assert(locked.refCount() == 3);
+  }
+  assert(Tracked::alive == 0);
+  assert(weak.expired() && !weak.lock());
+  weak.reset();
+
+  // Parent <-> child cycle, the child only observes its parent
+  struct Node {
+    SingleThreadSharedPtr<Node> child;
+    SingleThreadWeakPtr<Node> parent;
+    Tracked tracked;
+  };
+  {
+    SingleThreadSharedPtr<Node> parent(new Node());
+    parent->child = SingleThreadSharedPtr<Node>(new Node());
+    parent->child->parent = parent;
+    assert(parent->child->parent.lock() == parent);
+    assert(parent.refCount() == 1);
+    assert(Tracked::alive == 2);
+  }
+  assert(Tracked::alive == 0);
+
+  // Handles stay two pointers wide
+  static_assert(sizeof(SingleThreadSharedPtr<int>) == 2 * sizeof(void*));
+}
+
+// Test 6: Single allocation factories
+void runTest6() {
+  PRINT_TEST_HEADER(6);
+  Tracked::alive = 0;
+
+  // makeShared: object and counts together, released in two steps
+  SingleThreadWeakPtr<Tracked> weak;
+  {
+    auto child = MySmartPtrs::makeSingleThreadShared<TrackedChild>(3);
+    SingleThreadSharedPtr<Tracked> base = child;
+    assert(base->value == 3 && base.refCount() == 2);
+    weak = base;
+  }
+  assert(Tracked::alive == 0);
+  assert(weak.expired());
+  weak.reset();
+
+  auto atomic = MySmartPtrs::makeShared<Tracked>(4);
+  static_assert(std::is_same_v<decltype(atomic), ThreadSafeSharedPtr<Tracked>>);
+  assert(atomic->value == 4 && atomic.refCount() == 1);
+  atomic.reset();
+  assert(Tracked::alive == 0);
+
+  // allocateShared: exactly one allocation, placed in the arena
+  TestArena arena;
+  {
+    TestArenaAllocator<Tracked> alloc(arena);
+    auto ptr = MySmartPtrs::allocateSingleThreadShared<Tracked>(alloc, 5);
+    assert(arena.allocations == 1);
+    assert(arena.contains(ptr.get()));
+    assert(ptr->value == 5);
+
+    // The block outlives the object while WeakPtrs still look at it
+    weak = ptr;
+    ptr.reset();
+    assert(Tracked::alive == 0);
+    assert(arena.deallocations == 0);
+    weak.reset();
+    assert(arena.deallocations == 1);
+  }
+
+  // A throwing constructor gives the block back
+  TestArenaAllocator<ThrowsOnConstruct> throwingAlloc(arena);
+  bool threw = false;
+  try {
+    MySmartPtrs::allocateShared<ThrowsOnConstruct>(throwingAlloc);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+  assert(arena.allocations == 2 && arena.deallocations == 2);
+}
+
+// Test 7: Intrusive pointers
+void runTest7() {
+  PRINT_TEST_HEADER(7);
+  Tracked::alive = 0;
+
+  using LocalNode = IntrusiveNode<MySmartPtrs::SingleThreadRefCount>;
+  using SharedNode = IntrusiveNode<MySmartPtrs::AtomicRefCount>;
+
+  // Just one pointer, and no separate count object
+  static_assert(sizeof(MySmartPtrs::IntrusivePtr<LocalNode>) == sizeof(void*));
+
+  {
+    // A small chain, each node owned by the previous one
+    auto head = MySmartPtrs::makeIntrusive<LocalNode>(0);
+    auto tail = head;
+    for (int i = 1; i < 5; i++) {
+      tail->next = MySmartPtrs::makeIntrusive<LocalNode>(i);
+      tail = tail->next;
+    }
+    assert(Tracked::alive == 5);
+    assert(head.refCount() == 1 && tail.refCount() == 2);
+
+    // Any raw pointer to the node can make a new owner, the count is inside
+    MySmartPtrs::IntrusivePtr<LocalNode> again(tail.get());
+    assert(again.refCount() == 3 && again == tail);
+
+    // Assigning from a member of the node we let go of
+    tail.reset();
+    again.reset();
+    head = head->next;
+    assert(Tracked::alive == 4);
+    assert(head->value == 1 && head.refCount() == 1);
+
+    // detach() hands the reference over without touching the count
+    LocalNode* raw = head.detach();
+    assert(!head && intrusivePtrRefCount(raw) == 1);
+    MySmartPtrs::IntrusivePtr<LocalNode> adopted(raw, false);
+    assert(adopted.refCount() == 1);
+  }
+  assert(Tracked::alive == 0);
+
+  // Copies of the object don't copy its count
+  {
+    auto ptr = MySmartPtrs::makeIntrusive<LocalNode>(1);
+    LocalNode copy(*ptr);
+    assert(intrusivePtrRefCount(&copy) == 0);
+  }
+  assert(Tracked::alive == 0);
+
+  // Atomic policy, copies made and dropped from many threads
+  {
+    auto shared = MySmartPtrs::makeIntrusive<SharedNode>(42);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+      threads.emplace_back([&shared] {
+        for (int i = 0; i < 100000; i++) {
+          MySmartPtrs::IntrusivePtr<SharedNode> copy(shared);
+          assert(copy->value == 42);
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    assert(shared.refCount() == 1);
+  }
+  assert(Tracked::alive == 0);
+
+  // ADL hooks written by hand
+  {
+    MySmartPtrs::IntrusivePtr<LegacyCounted> a(new LegacyCounted());
+    auto b = a;
+    assert(a->refs == 2 && b.refCount() == 2);
+  }
+  assert(LegacyCounted::deleted == 1);
+}
+
+// Test 8: Custom deleters and deferred reclamation
+void runTest8() {
+  PRINT_TEST_HEADER(8);
+  Tracked::alive = 0;
+
+  // Plain custom deleter
+  int deleted = 0;
+  {
+    SingleThreadSharedPtr<Tracked> ptr(new Tracked(1), [&](Tracked* obj) {
+      deleted++;
+      delete obj;
+    });
+    auto copy = ptr;
+  }
+  assert(deleted == 1 && Tracked::alive == 0);
+
+  // Stateless deleters take no room in the block
+  static_assert(
+      sizeof(MySmartPtrs::DeleterControlBlock<
+             int, MySmartPtrs::AtomicRefCount, MySmartPtrs::QuiescentDelete>) ==
+      sizeof(MySmartPtrs::PointerControlBlock<int,
+                                              MySmartPtrs::AtomicRefCount>));
+
+  // Background queue: the releasing thread never runs the destructor
+  {
+    MySmartPtrs::ReclamationQueue queue;
+    MySmartPtrs::DeferredDelete deferred{&queue};
+
+    ThreadSafeSharedPtr<ThreadTracked> ptr(new ThreadTracked(2), deferred);
+    ThreadSafeWeakPtr<ThreadTracked> weak(ptr);
+    ptr.reset();
+    assert(weak.expired());
+    queue.drain();
+    assert(Tracked::alive == 0);
+    assert(ThreadTracked::destroyedOn != std::this_thread::get_id());
+    assert(queue.reclaimedCount() == 1);
+
+    // Many threads dropping their last references at once
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([deferred] {
+        for (int i = 0; i < 1000; i++) {
+          ThreadSafeSharedPtr<Tracked> obj(new Tracked(i), deferred);
+          auto copy = obj;
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    queue.drain();
+    assert(queue.reclaimedCount() == 4001);
+    assert(Tracked::alive == 0);
+
+    // Whatever is left when the queue goes away is freed by its destructor
+    ThreadSafeSharedPtr<Tracked>(new Tracked(3), deferred).reset();
+  }
+  assert(Tracked::alive == 0);
+
+  // Per-thread batch: nothing is freed until the thread says so
+  {
+    SingleThreadSharedPtr<Tracked> ptr(new Tracked(4),
+                                       MySmartPtrs::QuiescentDelete{});
+    ptr.reset(new Tracked(5), MySmartPtrs::QuiescentDelete{});
+    ptr.reset();
+    assert(Tracked::alive == 2);
+    assert(MySmartPtrs::reclaimQuiescent() == 2);
+    assert(Tracked::alive == 0);
+    assert(MySmartPtrs::reclaimQuiescent() == 0);
+  }
+
+  // ... or exits
+  std::thread([] {
+    SingleThreadSharedPtr<Tracked> ptr(new Tracked(6),
+                                       MySmartPtrs::QuiescentDelete{});
+  }).join();
+  assert(Tracked::alive == 0);
+}
+
+// Test 9: Atomic shared pointers
+void runTest9() {
+  PRINT_TEST_HEADER(9);
+  Tracked::alive = 0;
+
+  using MySmartPtrs::makeShared;
+  {
+    MySmartPtrs::AtomicSharedPtr<Tracked> atomic;
+    assert(!atomic.load());
+
+    auto first = makeShared<Tracked>(1);
+    atomic.store(first);
+    assert(atomic.load() == first);
+    assert(first.refCount() == 2);
+
+    auto old = atomic.exchange(makeShared<Tracked>(2));
+    assert(old == first && atomic.load()->value == 2);
+
+    // Fails against a different owner and hands back the current value
+    ThreadSafeSharedPtr<Tracked> expected = first;
+    assert(!atomic.compare_exchange_strong(expected, makeShared<Tracked>(3)));
+    assert(expected->value == 2);
+    assert(atomic.compare_exchange_strong(expected, first));
+    assert(atomic.load() == first);
+
+    // Empty values go through too
+    expected = first;
+    assert(atomic.compare_exchange_weak(expected, nullptr));
+    assert(!atomic.load());
+    expected.reset();
+    assert(atomic.compare_exchange_strong(expected, first));
+    assert(first.refCount() == 3);
+  }
+  assert(Tracked::alive == 0);
+
+  // Readers never see a half built or freed snapshot while writers swap
+  {
+    MySmartPtrs::AtomicSharedPtr<Snapshot> current(makeShared<Snapshot>(0));
+    std::atomic<bool> done = false;
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+      readers.emplace_back([&] {
+        int lastSeen = 0;
+        while (!done.load()) {
+          auto snapshot = current.load();
+          assert(snapshot->consistent());
+          assert(snapshot->value >= lastSeen);
+          lastSeen = snapshot->value;
+        }
+      });
+    }
+
+    // One thread bumps the version by storing, one with compare_exchange
+    std::atomic<int> version = 0;
+    std::vector<std::thread> writers;
+    writers.emplace_back([&] {
+      for (int i = 0; i < 2000; i++) {
+        current.store(makeShared<Snapshot>(++version));
+      }
+    });
+    writers.emplace_back([&] {
+      for (int i = 0; i < 2000; i++) {
+        auto expected = current.load();
+        while (!current.compare_exchange_weak(
+            expected, makeShared<Snapshot>(expected->value))) {
+        }
+      }
+    });
+    for (auto& t : writers) t.join();
+    done = true;
+    for (auto& t : readers) t.join();
+
+    assert(current.load()->value == 2000);
+    assert(Tracked::alive == 1);
+  }
+  assert(Tracked::alive == 0);
+
+  // More readers alive at once than a block has slots, and a writer waiting
+  // on all of them
+  {
+    using MySmartPtrs::HazardSlots;
+    MySmartPtrs::AtomicSharedPtr<Tracked> atomic(makeShared<Tracked>(0));
+    const size_t threadCount = 2 * HazardSlots::SlotsPerBlock + 8;
+    std::latch allReading(static_cast<ptrdiff_t>(threadCount + 1));
+    std::atomic<bool> done = false;
+
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threadCount; t++) {
+      readers.emplace_back([&] {
+        assert(atomic.load());
+        allReading.arrive_and_wait();
+        while (!done.load()) assert(atomic.load()->value >= 0);
+      });
+    }
+
+    allReading.arrive_and_wait();
+    for (int i = 1; i <= 100; i++) atomic.store(makeShared<Tracked>(i));
+    done = true;
+    for (auto& t : readers) t.join();
+
+    assert(atomic.load()->value == 100);
+    assert(Tracked::alive == 1);
+  }
+  assert(Tracked::alive == 0);
+}
+
+// Test 10: Aliasing, deleters for foreign memory, getDeleter
+void runTest10() {
+  PRINT_TEST_HEADER(10);
+  Tracked::alive = 0;
+
+  // mmap'd buffer, refcounted once and handed out as zero-copy views
+  constexpr size_t pageSize = 4096;
+  void* pages = mmap(nullptr, pageSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  assert(pages != MAP_FAILED);
+  std::memcpy(pages, "headerpayload", 14);
+
+  SingleThreadSharedPtr<std::byte> view;
+  {
+    SingleThreadSharedPtr<std::byte> buffer(static_cast<std::byte*>(pages),
+                                            Unmap{pageSize});
+    assert(buffer.getDeleter<Unmap>()->length == pageSize);
+    assert(buffer.getDeleter<MySmartPtrs::QuiescentDelete>() == nullptr);
+
+    SingleThreadSharedPtr<std::byte> header(buffer, buffer.get());
+    view = SingleThreadSharedPtr<std::byte>(buffer, buffer.get() + 6);
+    assert(buffer.refCount() == 3 && view.refCount() == 3);
+    assert(std::memcmp(header.get(), "header", 6) == 0);
+
+    // Views report the buffer's deleter, they share its control block
+    assert(view.getDeleter<Unmap>() == buffer.getDeleter<Unmap>());
+  }
+  // The buffer is still mapped, the view keeps it alive
+  assert(view.refCount() == 1);
+  assert(std::memcmp(view.get(), "payload", 7) == 0);
+  view.reset();
+
+  // Pointing at a member keeps the whole object alive
+  SingleThreadSharedPtr<int> member;
+  {
+    auto parent = MySmartPtrs::makeSingleThreadShared<Tracked>(8);
+    member = SingleThreadSharedPtr<int>(parent, &parent->value);
+    int* value = &parent->value;
+    SingleThreadSharedPtr<int> moved(std::move(parent), value);
+    assert(!parent && moved.refCount() == 2);
+  }
+  assert(Tracked::alive == 1 && *member == 8);
+  member.reset();
+  assert(Tracked::alive == 0);
+  assert(member.getDeleter<Unmap>() == nullptr);
+
+  // Object and control block both in an arena, no heap involved
+  TestArena arena;
+  {
+    TestArenaAllocator<Tracked> alloc(arena);
+    Tracked* obj = std::construct_at(alloc.allocate(1), 9);
+    auto destroyOnly = [](Tracked* t) { std::destroy_at(t); };
+
+    SingleThreadSharedPtr<Tracked> ptr(obj, destroyOnly, alloc);
+    assert(arena.allocations == 2);
+    assert(arena.contains(ptr.get()));
+    assert(ptr->value == 9 && ptr.getDeleter<decltype(destroyOnly)>());
+  }
+  assert(Tracked::alive == 0);
+  assert(arena.deallocations == 1);
+}
+
+// Test 11: Heap allocations made by each way of owning an object
+void runTest11() {
+  PRINT_TEST_HEADER(11);
+  Tracked::alive = 0;
+
+  // Runs f and returns how many heap allocations it made
+  auto allocationsOf = [](auto&& f) {
+    const size_t start = HEAP_ALLOC_COUNT;
+    f();
+    return HEAP_ALLOC_COUNT - start;
+  };
+
+  // Object and counts apart, or together
+  SingleThreadSharedPtr<Tracked> separate, inplace;
+  assert(allocationsOf([&] { separate.reset(new Tracked(1)); }) == 2);
+  assert(allocationsOf([&] {
+           inplace = MySmartPtrs::makeSingleThreadShared<Tracked>(2);
+         }) == 1);
+
+  // Copies, moves, aliases and weak pointers never allocate
+  assert(allocationsOf([&] {
+           auto copy = inplace;
+           auto moved = std::move(copy);
+           SingleThreadSharedPtr<int> alias(moved, &moved->value);
+           SingleThreadWeakPtr<Tracked> weak(moved);
+           auto locked = weak.lock();
+           separate = locked;
+         }) == 0);
+
+  // Deleters live in the control block
+  assert(allocationsOf([&] {
+           SingleThreadSharedPtr<Tracked> ptr(
+               new Tracked(3), [](Tracked* obj) { delete obj; });
+         }) == 2);
+
+  // The count is inside the object, nothing else to allocate
+  using LocalNode = IntrusiveNode<MySmartPtrs::SingleThreadRefCount>;
+  assert(allocationsOf([&] {
+           auto node = MySmartPtrs::makeIntrusive<LocalNode>(4);
+           auto copy = node;
+         }) == 1);
+
+  separate.reset();
+  inplace.reset();
+  assert(Tracked::alive == 0);
+}
+
 }  // namespace Tests